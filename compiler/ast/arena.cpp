@@ -0,0 +1,53 @@
+#include <defs.h>
+
+#include "arena.h"
+
+ast::Arena::~Arena()
+{
+	for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+		it->destroy(it->instance);
+
+	for (auto chunk : chunks)
+		_FREE_POOL(chunk);
+}
+
+void ast::Arena::merge(Arena& other)
+{
+	// chunks never move so the nodes of 'other' stay where they are and
+	// only their ownership changes
+
+	chunks.insert(chunks.end(), other.chunks.begin(), other.chunks.end());
+	destructors.insert(destructors.end(), other.destructors.begin(), other.destructors.end());
+
+	nodes_count += other.nodes_count;
+
+	other.chunks.clear();
+	other.destructors.clear();
+	other.cursor = nullptr;
+	other.chunk_left = 0;
+	other.nodes_count = 0;
+}
+
+void* ast::Arena::allocate(size_t size, size_t alignment)
+{
+	const auto padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+
+	if (size + padding > chunk_left)
+	{
+		// chunks come straight from the allocator so they are
+		// aligned for any node type, nodes are constructed in place
+		// so the memory isn't zeroed first
+
+		cursor = chunks.emplace_back(_ALLOC_POOL_UNINIT(uint8_t, CHUNK_SIZE));
+		chunk_left = CHUNK_SIZE;
+
+		return allocate(size, alignment);
+	}
+
+	const auto instance = cursor + padding;
+
+	cursor += padding + size;
+	chunk_left -= padding + size;
+
+	return instance;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+namespace ast
+{
+	/*
+	* bump allocator owning every node of the tree, nodes are constructed
+	* in place inside big chunks and the whole tree is released at once,
+	* only the nodes owning memory of their own get their destructor called
+	* and leaks are tracked per chunk instead of per node
+	*/
+	class Arena
+	{
+	private:
+
+		static constexpr size_t CHUNK_SIZE = 0x40000;
+
+		struct Destructor
+		{
+			void* instance;
+
+			void (*destroy)(void*);
+		};
+
+		std::vector<uint8_t*> chunks;
+		std::vector<Destructor> destructors;
+
+		uint8_t* cursor = nullptr;
+
+		size_t chunk_left = 0,
+			   nodes_count = 0;
+
+		void* allocate(size_t size, size_t alignment);
+
+	public:
+
+		Arena() = default;
+		Arena(const Arena&) = delete;
+		~Arena();
+
+		Arena& operator = (const Arena&) = delete;
+
+		template <typename T, typename... A>
+		T* create(A&&... args)
+		{
+			static_assert(sizeof(T) <= CHUNK_SIZE);
+
+			auto instance = new (allocate(sizeof(T), alignof(T))) T(std::forward<A>(args)...);
+
+			if constexpr (!std::is_trivially_destructible_v<T>)
+				destructors.push_back({ instance, [](void* v) { static_cast<T*>(v)->~T(); } });
+
+			++nodes_count;
+
+			return instance;
+		}
+
+		void merge(Arena& other);
+
+		size_t get_chunks_count() const		{ return chunks.size(); }
+		size_t get_nodes_count() const		{ return nodes_count; }
+	};
+}
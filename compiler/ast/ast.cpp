@@ -3,6 +3,7 @@
 #include <lexer/lexer.h>
 
 #include "ast.h"
+#include "visitor.h"
 
 void ast::Printer::print(AST* ast)
 {
@@ -16,7 +17,7 @@ void ast::Printer::print_prototype(Prototype* prototype)
 	if (first_prototype_printed)
 		PRINT_NL;
 
-	PRINT_TABS(White, 0, "prototype '{}'", prototype->name);
+	PRINT_TABS(White, 0, "prototype '{}'", prototype->name.str());
 
 	if (!prototype->params.empty())
 	{
@@ -24,7 +25,7 @@ void ast::Printer::print_prototype(Prototype* prototype)
 
 		print_vec<ExprDecl>(Green, prototype->params, ", ", [](ExprDecl* e)
 		{
-			return e->type.str() + " " + e->name;
+			return e->type.str() + " " + std::string(e->name.str());
 		});
 	}
 
@@ -32,11 +33,15 @@ void ast::Printer::print_prototype(Prototype* prototype)
 	{
 		PRINT_TABS_NL(White, 0, " (decl)");
 	}
+	else if (!prototype->body)
+	{
+		PRINT_TABS_NL(White, 0, " (body not parsed)");
+	}
 	else
 	{
 		PRINT_NL;
 
-		print_body(prototype->body);
+		print_stmt(prototype->body);
 
 		PRINT_TABS_NL(White, curr_level, "end");
 	}
@@ -44,99 +49,202 @@ void ast::Printer::print_prototype(Prototype* prototype)
 	first_prototype_printed = true;
 }
 
-void ast::Printer::print_body(StmtBody* body)
+void ast::Printer::print_stmt(Base* stmt)
 {
-	++curr_level;
+	// compound statements are frames in 'frames' instead of calls so the
+	// nesting depth is only limited by memory, frames below 'base' belong
+	// to the caller
 
-	PRINT_TABS_NL(Cyan, curr_level, "body");
+	const auto base = frames.size();
 
-	for (auto stmt_base : body->stmts)
-		print_stmt(stmt_base);
+	open_stmt(stmt);
 
-	PRINT_TABS_NL(Cyan, curr_level, "end");
+	while (frames.size() > base)
+	{
+		const auto frame = frames.back();
 
-	--curr_level;
+		++frames.back().step;
+
+		bool done = true;
+
+		visit_stmt(frame.stmt, Visitor
+		{
+			[&](StmtBody* body)						{ done = print_body(body, frame.step); },
+			[&](StmtIf* stmt_if)					{ done = print_if(stmt_if, frame.step); },
+			[&](StmtFor* stmt_for)					{ done = print_for(stmt_for, frame.step); },
+			[&](StmtWhile* stmt_while)				{ done = print_while(stmt_while, frame.step); },
+			[&](StmtDoWhile* stmt_do_while)			{ done = print_do_while(stmt_do_while, frame.step); },
+			[&](StmtBreak*)							{},
+			[&](StmtContinue*)						{},
+			[&](StmtReturn*)						{},
+			[&](Expr*)								{},
+		});
+
+		// the last step of a statement never opens another one so the
+		// frame on top is still its own
+
+		if (done)
+			frames.pop_back();
+	}
 }
 
-void ast::Printer::print_stmt(Base* stmt)
+void ast::Printer::open_stmt(Base* stmt)
 {
-	if (auto body = rtti::cast<StmtBody>(stmt))						print_body(body);
-	else if (auto stmt_if = rtti::cast<StmtIf>(stmt))				print_if(stmt_if);
-	else if (auto stmt_for = rtti::cast<StmtFor>(stmt))				print_for(stmt_for);
-	else if (auto stmt_while = rtti::cast<StmtWhile>(stmt))			print_while(stmt_while);
-	else if (auto stmt_do_while = rtti::cast<StmtDoWhile>(stmt))	print_do_while(stmt_do_while);
-	else if (auto stmt_break = rtti::cast<StmtBreak>(stmt))			print_break(stmt_break);
-	else if (auto stmt_continue = rtti::cast<StmtContinue>(stmt))	print_continue(stmt_continue);
-	else if (auto stmt_return = rtti::cast<StmtReturn>(stmt))		print_return(stmt_return);
-	else if (auto expr = rtti::cast<Expr>(stmt))					print_expr(expr);
+	if (!stmt)
+		return;
+
+	visit_stmt(stmt, Visitor
+	{
+		[&](StmtBody* body)						{ frames.push_back({ body }); },
+		[&](StmtIf* stmt_if)					{ frames.push_back({ stmt_if }); },
+		[&](StmtFor* stmt_for)					{ frames.push_back({ stmt_for }); },
+		[&](StmtWhile* stmt_while)				{ frames.push_back({ stmt_while }); },
+		[&](StmtDoWhile* stmt_do_while)			{ frames.push_back({ stmt_do_while }); },
+		[&](StmtBreak* stmt_break)				{ print_break(stmt_break); },
+		[&](StmtContinue* stmt_continue)		{ print_continue(stmt_continue); },
+		[&](StmtReturn* stmt_return)			{ print_return(stmt_return); },
+		[&](Expr* expr)							{ print_expr(expr); },
+	});
 }
 
-void ast::Printer::print_if(StmtIf* stmt_if)
+bool ast::Printer::print_body(StmtBody* body, uint32_t step)
 {
-	++curr_level;
+	if (step == 0)
+	{
+		++curr_level;
 
-	PRINT_TABS_NL(Blue, curr_level, "if");
+		PRINT_TABS_NL(Cyan, curr_level, "body");
+	}
+	else if (step <= body->stmts.size())
+		open_stmt(body->stmts[step - 1]);
+	else
+	{
+		PRINT_TABS_NL(Cyan, curr_level, "end");
 
-	print_expr(stmt_if->expr);
-	print_body(stmt_if->if_body);
+		--curr_level;
 
-	for (auto else_if : stmt_if->ifs)
+		return true;
+	}
+
+	return false;
+}
+
+bool ast::Printer::print_if(StmtIf* stmt_if, uint32_t step)
+{
+	// 'if' first, then every 'else if' and the 'else' last
+
+	const auto else_ifs_count = stmt_if->ifs.size();
+
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "if");
+
+		print_expr(stmt_if->expr);
+		open_stmt(stmt_if->if_body);
+	}
+	else if (step <= else_ifs_count)
 	{
+		const auto else_if = stmt_if->ifs[step - 1];
+
 		PRINT_TABS_NL(Blue, curr_level, "else if");
 
 		print_expr(else_if->expr);
-		print_body(else_if->if_body);
+		open_stmt(else_if->if_body);
 	}
+	else if (step == else_ifs_count + 1)
+	{
+		if (stmt_if->else_body)
+		{
+			PRINT_TABS_NL(Blue, curr_level, "else");
 
-	if (stmt_if->else_body)
+			open_stmt(stmt_if->else_body);
+		}
+	}
+	else
 	{
-		PRINT_TABS_NL(Blue, curr_level, "else");
+		--curr_level;
 
-		print_body(stmt_if->else_body);
+		return true;
 	}
 
-	--curr_level;
+	return false;
 }
 
-void ast::Printer::print_for(ast::StmtFor* stmt_for)
+bool ast::Printer::print_for(ast::StmtFor* stmt_for, uint32_t step)
 {
-	++curr_level;
+	switch (step)
+	{
+	case 0:
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "for");
 
-	PRINT_TABS_NL(Blue, curr_level, "for");
+		open_stmt(stmt_for->init);
 
-	print_stmt(stmt_for->init);
-	print_expr(stmt_for->condition);
-	print_stmt(stmt_for->step);
-	print_body(stmt_for->body);
+		return false;
+	}
+	case 1:
+	{
+		print_expr(stmt_for->condition);
+		open_stmt(stmt_for->step);
+
+		return false;
+	}
+	case 2:
+	{
+		open_stmt(stmt_for->body);
+
+		return false;
+	}
+	}
 
 	--curr_level;
+
+	return true;
 }
 
-void ast::Printer::print_while(StmtWhile* stmt_while)
+bool ast::Printer::print_while(StmtWhile* stmt_while, uint32_t step)
 {
-	++curr_level;
+	if (step == 0)
+	{
+		++curr_level;
 
-	PRINT_TABS_NL(Blue, curr_level, "while");
+		PRINT_TABS_NL(Blue, curr_level, "while");
 
-	print_expr(stmt_while->condition);
-	print_body(stmt_while->body);
+		print_expr(stmt_while->condition);
+		open_stmt(stmt_while->body);
+
+		return false;
+	}
 
 	--curr_level;
+
+	return true;
 }
 
-void ast::Printer::print_do_while(StmtDoWhile* stmt_do_while)
+bool ast::Printer::print_do_while(StmtDoWhile* stmt_do_while, uint32_t step)
 {
-	++curr_level;
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "do");
 
-	PRINT_TABS_NL(Blue, curr_level, "do");
+		open_stmt(stmt_do_while->body);
 
-	print_body(stmt_do_while->body);
+		return false;
+	}
 
 	PRINT_TABS_NL(Blue, curr_level, "while");
 
 	print_expr(stmt_do_while->condition);
 
 	--curr_level;
+
+	return true;
 }
 
 void ast::Printer::print_break(StmtBreak* stmt_break)
@@ -168,22 +276,28 @@ void ast::Printer::print_expr(Expr* expr)
 {
 	++curr_level;
 
-	if (auto int_literal = rtti::cast<ExprIntLiteral>(expr))		print_expr_int(int_literal);
-	else if (auto id = rtti::cast<ExprId>(expr))					print_id(id);
-	else if (auto decl = rtti::cast<ExprDecl>(expr))				print_decl(decl);
-	else if (auto assign = rtti::cast<ExprAssign>(expr))			print_assign(assign);
-	else if (auto bin_assign = rtti::cast<ExprBinaryAssign>(expr))  print_binary_assign(bin_assign);
-	else if (auto binary_op = rtti::cast<ExprBinaryOp>(expr))		print_expr_binary_op(binary_op);
-	else if (auto unary_op = rtti::cast<ExprUnaryOp>(expr))			print_expr_unary_op(unary_op);
-	else if (auto call = rtti::cast<ExprCall>(expr))				print_expr_call(call);
-	else if (auto cast = rtti::cast<ExprCast>(expr))				print_cast(cast);
+	if (expr)
+	{
+		visit_expr(expr, Visitor
+		{
+			[&](ExprIntLiteral* int_literal)		{ print_expr_int(int_literal); },
+			[&](ExprId* id)							{ print_id(id); },
+			[&](ExprDecl* decl)						{ print_decl(decl); },
+			[&](ExprAssign* assign)					{ print_assign(assign); },
+			[&](ExprBinaryAssign* bin_assign)		{ print_binary_assign(bin_assign); },
+			[&](ExprBinaryOp* binary_op)			{ print_expr_binary_op(binary_op); },
+			[&](ExprUnaryOp* unary_op)				{ print_expr_unary_op(unary_op); },
+			[&](ExprCall* call)						{ print_expr_call(call); },
+			[&](ExprCast* cast)						{ print_cast(cast); },
+		});
+	}
 
 	--curr_level;
 }
 
 void ast::Printer::print_decl(ExprDecl* decl)
 {
-	PRINT_TABS_NL(Yellow, curr_level, "decl.{} ({}) '{}'", decl->rhs ? " assignment" : "", decl->type.str_full(), decl->name);
+	PRINT_TABS_NL(Yellow, curr_level, "decl.{} ({}) '{}'", decl->rhs ? " assignment" : "", decl->type.str_full(), decl->name.str());
 
 	if (decl->rhs)
 		print_expr(decl->rhs);
@@ -207,7 +321,7 @@ void ast::Printer::print_binary_assign(ExprBinaryAssign* bin_assign)
 
 void ast::Printer::print_expr_int(ExprIntLiteral* expr)
 {
-	if (expr->type.flags & TypeFlag_Unsigned)
+	if (expr->type.is_unsigned())
 	{
 		PRINT_TABS_NL(Yellow, curr_level, "int ({}) '{}'", expr->type.str(), expr->integer.u64);
 	}
@@ -219,7 +333,7 @@ void ast::Printer::print_expr_int(ExprIntLiteral* expr)
 
 void ast::Printer::print_id(ast::ExprId* expr)
 {
-	PRINT_TABS_NL(Yellow, curr_level, "id ({}) '{}'", expr->type.str_full(), expr->name);
+	PRINT_TABS_NL(Yellow, curr_level, "id ({}) '{}'", expr->type.str_full(), expr->name.str());
 }
 
 void ast::Printer::print_expr_unary_op(ast::ExprUnaryOp* expr)
@@ -247,7 +361,7 @@ void ast::Printer::print_expr_binary_op(ExprBinaryOp* expr)
 
 void ast::Printer::print_expr_call(ExprCall* expr)
 {
-	PRINT_TABS_NL(Yellow, curr_level, "prototype call ({})", expr->name);
+	PRINT_TABS_NL(Yellow, curr_level, "prototype call ({})", expr->name.str());
 
 	for (auto param : expr->exprs)
 	{
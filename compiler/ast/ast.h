@@ -3,27 +3,27 @@
 #include <lexer/lexer.h>
 
 #include "types.h"
+#include "arena.h"
 
 namespace ast
 {
 	struct Base
 	{
 		StmtExprType stmt_type = Stmt_None;
-
-		virtual ~Base() = default;
 	};
 
 	struct Expr : public Base
 	{
-		std::string name;
+		Symbol name;
 
 		Expr* lhs = nullptr,
 			* rhs = nullptr;
 
 		Type type {};
 
+		uint32_t analyzed_epoch = 0;
+
 		Expr()								{ stmt_type = StmtExpr; }
-		~Expr()								{}
 
 		static bool check_class(Base* i)	{ return i->stmt_type > StmtExpr_Begin && i->stmt_type < StmtExpr_End; }
 	};
@@ -32,11 +32,10 @@ namespace ast
 	{
 		Int integer = { 0 };
 
-		ExprIntLiteral(const std::string& name, const Type& type)
+		ExprIntLiteral(Int value, const Type& type)
 		{
 			stmt_type = StmtExpr_IntLiteral;
-			integer = std::stoll(name);
-			this->name = name;
+			integer = value;
 			this->type = type;
 		}
 
@@ -47,7 +46,7 @@ namespace ast
 
 	struct ExprId : public Expr
 	{
-		ExprId(const std::string& name)
+		ExprId(Symbol name)
 		{
 			stmt_type = StmtExpr_Id;
 			this->name = name;
@@ -58,7 +57,7 @@ namespace ast
 
 	struct ExprDecl : public Expr
 	{
-		ExprDecl(const std::string& name, const Type& type, Expr* rhs = nullptr)
+		ExprDecl(Symbol name, const Type& type, Expr* rhs = nullptr)
 		{
 			stmt_type = StmtExpr_Decl;
 			this->name = name;
@@ -66,8 +65,6 @@ namespace ast
 			this->type = type;
 		}
 
-		~ExprDecl()							{ _FREE(rhs); }
-
 		static bool check_class(Base* i)	{ return i->stmt_type == StmtExpr_Decl; }
 	};
 
@@ -80,8 +77,6 @@ namespace ast
 			this->rhs = rhs;
 		}
 
-		~ExprAssign()						{ _FREE(lhs); _FREE(rhs); }
-
 		static bool check_class(Base* i)	{ return i->stmt_type == StmtExpr_Assign; }
 	};
 
@@ -97,12 +92,6 @@ namespace ast
 			this->rhs = rhs;
 		}
 
-		~ExprBinaryAssign()
-		{
-			_FREE(lhs);
-			_FREE(rhs);
-		}
-
 		static bool check_class(Base* i)	{ return i->stmt_type == StmtExpr_BinAssign; }
 	};
 	
@@ -117,12 +106,6 @@ namespace ast
 			this->rhs = rhs;
 			this->type = type;
 		}
-
-		~ExprBinaryOp()
-		{
-			_FREE(lhs);
-			_FREE(rhs);
-		}
 			
 		static bool check_class(Base* i)	{ return i->stmt_type == StmtExpr_BinOp; }
 	};
@@ -140,12 +123,6 @@ namespace ast
 			else			this->rhs = expr;
 		}
 
-		~ExprUnaryOp()
-		{
-			_FREE(lhs);
-			_FREE(rhs);
-		}
-
 		static bool check_class(Base* i)	{ return i->stmt_type == StmtExpr_UnaryOp; }
 	};
 
@@ -157,17 +134,11 @@ namespace ast
 
 		bool intrinsic = false;
 
-		ExprCall(const std::string& name, bool built_in = false) : prototype(prototype), intrinsic(intrinsic)
+		ExprCall(Symbol name, bool built_in = false) : prototype(prototype), intrinsic(intrinsic)
 		{
 			stmt_type = StmtExpr_Call;
 			this->name = name;
 		}
-
-		~ExprCall()
-		{
-			for (auto stmt : exprs)
-				_FREE(stmt);
-		}
 			
 		static bool check_class(Base* i)				{ return i->stmt_type == StmtExpr_Call; }
 	};
@@ -178,7 +149,6 @@ namespace ast
 
 		ExprCast(Expr* rhs, const Type& type, bool implicit = true) : implicit(implicit)
 											{ stmt_type = StmtExpr_Cast; this->rhs = rhs; this->type = type; }
-		~ExprCast()							{ _FREE(rhs); }
 
 		bool needs_ir_cast() const			{ return rhs->type.get_size() != type.get_size(); }
 
@@ -190,11 +160,6 @@ namespace ast
 		std::vector<Base*> stmts;
 
 		StmtBody()						 { stmt_type = Stmt_Body; }
-		~StmtBody()
-		{
-			for (auto stmt : stmts)
-				_FREE(stmt);
-		}
 
 		static bool check_class(Base* i) { return i->stmt_type == Stmt_Body; }
 	};
@@ -210,16 +175,6 @@ namespace ast
 
 		StmtIf(Expr* expr, StmtBody* if_body) : expr(expr), if_body(if_body) 
 											{ stmt_type = Stmt_If; }
-		~StmtIf()
-		{
-			_FREE(else_body);
-
-			for (auto _if : ifs)
-				_FREE(_if);
-
-			_FREE(if_body);
-			_FREE(expr);
-		}
 			
 		static bool check_class(Base* i)	{ return i->stmt_type == Stmt_If; }
 	};
@@ -236,13 +191,6 @@ namespace ast
 		StmtFor(Expr* condition, Base* init, Base* step, StmtBody* body)
 				: condition(condition), init(init), step(step), body(body)
 											{ stmt_type = Stmt_For; }
-		~StmtFor()
-		{
-			_FREE(body);
-			_FREE(step);
-			_FREE(init);
-			_FREE(condition);
-		}
 
 		static bool check_class(Base* i) { return i->stmt_type == Stmt_For; }
 	};
@@ -255,11 +203,6 @@ namespace ast
 
 		StmtWhile(Expr* condition, StmtBody* body) : condition(condition), body(body)
 						{ stmt_type = Stmt_While; }
-		~StmtWhile()
-		{
-			_FREE(body);
-			_FREE(condition);
-		}
 
 		static bool check_class(Base* i) { return i->stmt_type == Stmt_While; }
 	};
@@ -272,11 +215,6 @@ namespace ast
 
 		StmtDoWhile(Expr* condition, StmtBody* body) : condition(condition), body(body)
 											{ stmt_type = Stmt_DoWhile; }
-		~StmtDoWhile()
-		{
-			_FREE(body);
-			_FREE(condition);
-		}
 
 		static bool check_class(Base* i)	{ return i->stmt_type == Stmt_DoWhile; }
 	};
@@ -300,7 +238,6 @@ namespace ast
 		Expr* expr = nullptr;
 		
 		StmtReturn(Expr* expr) : expr(expr) { stmt_type = Stmt_Return; }
-		~StmtReturn()						{ _FREE(expr); }
 
 		static bool check_class(Base* i)	{ return i->stmt_type == Stmt_Return; }
 	};
@@ -309,20 +246,18 @@ namespace ast
 	{
 		std::vector<Expr*> params;
 
-		std::string name;
+		Symbol name;
 
 		StmtBody* body = nullptr;
 
 		Type type {};
 
-		Prototype(const std::string& name, const Type& type) : name(name), type(type) {}
-		~Prototype()
-		{
-			for (auto param : params)
-				_FREE(param);
+		// index of the '{' token of a body that was skipped by the parser,
+		// it's parsed the first time it's requested (see Syntax::get_body)
 
-			_FREE(body);
-		}
+		std::optional<size_t> lazy_body;
+
+		Prototype(Symbol name, const Type& type) : name(name), type(type) {}
 
 		Expr* get_param(int i)
 		{
@@ -332,33 +267,52 @@ namespace ast
 			return (i >= 0 && i < static_cast<int>(params.size()) ? params[i] : nullptr);
 		}
 
-		bool is_decl() const							{ return !body; }
+		bool is_decl() const							{ return !body && !lazy_body; }
 	};
 
 	struct AST
 	{
+		// every node of the tree lives in the arena and it's released
+		// along with the AST
+
+		Arena arena;
+
 		std::vector<Prototype*> prototypes;
+	};
 
-		~AST()
-		{
-			for (auto prototype : prototypes)	_FREE(prototype);
-		}
+	/*
+	* compound statement being printed, 'step' is the next part of it to
+	* print (see Printer::print_stmt)
+	*/
+	struct PrintFrame
+	{
+		Base* stmt = nullptr;
+
+		uint32_t step = 0;
 	};
 
 	struct Printer
 	{
+		std::vector<PrintFrame> frames;
+
 		int curr_level = 0;
 
 		bool first_prototype_printed = false;
 
 		void print(AST* ast);
 		void print_prototype(Prototype* prototype);
-		void print_body(StmtBody* body);
 		void print_stmt(Base* stmt);
-		void print_if(StmtIf* stmt_if);
-		void print_for(StmtFor* stmt_for);
-		void print_while(StmtWhile* stmt_while);
-		void print_do_while(StmtDoWhile* stmt_do_while);
+		void open_stmt(Base* stmt);
+
+		// every compound statement is printed one step at a time, they
+		// return true once the statement is done
+
+		bool print_body(StmtBody* body, uint32_t step);
+		bool print_if(StmtIf* stmt_if, uint32_t step);
+		bool print_for(StmtFor* stmt_for, uint32_t step);
+		bool print_while(StmtWhile* stmt_while, uint32_t step);
+		bool print_do_while(StmtDoWhile* stmt_do_while, uint32_t step);
+
 		void print_break(StmtBreak* stmt_break);
 		void print_continue(StmtContinue* stmt_continue);
 		void print_return(StmtReturn* stmt_return);
@@ -0,0 +1,115 @@
+#include <defs.h>
+
+#include <filesystem>
+
+#include "cache.h"
+
+std::string ast::Cache::get_filename(uint64_t key) const
+{
+	return std::format("{}/{:016x}.ast", path, key);
+}
+
+std::optional<uint64_t> ast::Cache::get_key(const std::string& filename) const
+{
+	MappedFile source;
+
+	if (!source.open(filename))
+		return {};
+
+	return hash(source.view(), VERSION);
+}
+
+bool ast::Cache::load(uint64_t key, FlatTree& tree) const
+{
+	MappedFile file;
+
+	if (!file.open(get_filename(key)))
+		return false;
+
+	return tree.deserialize(file.view());
+}
+
+bool ast::Cache::load(uint64_t key, AST* ast) const
+{
+	FlatTree tree;
+
+	if (!load(key, tree))
+		return false;
+
+	tree.expand(ast);
+
+	return true;
+}
+
+void ast::Cache::save(uint64_t key, const FlatTree& tree) const
+{
+	std::error_code ec;
+
+	std::filesystem::create_directories(path, ec);
+
+	std::string data;
+
+	tree.serialize(data);
+
+	// written under a temporary name first so a reader never sees
+	// a partial entry
+
+	const auto filename = get_filename(key),
+			   tmp_filename = filename + ".tmp";
+
+	{
+		std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+
+		if (!file.write(data.data(), data.size()))
+			return;
+	}
+
+	std::filesystem::rename(tmp_filename, filename, ec);
+}
+
+void ast::Cache::save(uint64_t key, AST* ast) const
+{
+	// trees with bodies still pending can't be stored, they point
+	// into the tokens of this run
+
+	if (std::ranges::any_of(ast->prototypes, [](Prototype* prototype) { return prototype->lazy_body.has_value(); }))
+		return;
+
+	save(key, FlatTree(ast));
+}
+
+uint64_t ast::Cache::hash(std::string_view data, uint64_t seed)
+{
+	// 8 bytes per step multiply-xorshift, it only needs to tell sources
+	// apart and it runs far faster than the lexer
+
+	static constexpr uint64_t K = 0x9e3779b97f4a7c15;
+
+	auto mix = [](uint64_t h)
+	{
+		h ^= h >> 32;
+		h *= K;
+		h ^= h >> 29;
+
+		return h;
+	};
+
+	uint64_t h = seed ^ (data.size() * K);
+
+	size_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t))
+	{
+		uint64_t word;
+
+		std::memcpy(&word, data.data() + i, sizeof(word));
+
+		h = (h ^ mix(word)) * K;
+	}
+
+	uint64_t tail = 0;
+
+	std::memcpy(&tail, data.data() + i, data.size() - i);
+
+	return mix(h ^ mix(tail));
+}
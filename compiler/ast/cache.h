@@ -0,0 +1,42 @@
+#pragma once
+
+#include "flat.h"
+
+namespace ast
+{
+	/*
+	* on-disk cache of parsed trees, every entry is the serialized flat
+	* tree of one source file named after the hash of its bytes so an
+	* unchanged source skips the lexer and the parser entirely
+	*/
+	class Cache
+	{
+	private:
+
+		// must be bumped whenever the parser or the layout of the tree
+		// changes, it's mixed into every key so old entries just miss
+
+		static constexpr uint64_t VERSION = 3;
+
+		std::string path;
+
+		std::string get_filename(uint64_t key) const;
+
+	public:
+
+		Cache(const std::string& path) : path(path) {}
+
+		std::optional<uint64_t> get_key(const std::string& filename) const;
+
+		// the flat versions skip the pointer tree, passes that read the
+		// flat tree directly (see FlatPrinter) use them as they are
+
+		bool load(uint64_t key, FlatTree& tree) const;
+		bool load(uint64_t key, AST* ast) const;
+
+		void save(uint64_t key, const FlatTree& tree) const;
+		void save(uint64_t key, AST* ast) const;
+
+		static uint64_t hash(std::string_view data, uint64_t seed);
+	};
+}
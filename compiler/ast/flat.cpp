@@ -0,0 +1,955 @@
+#include <defs.h>
+
+#include <lexer/lexer.h>
+#include <intrin/intrin.h>
+
+#include "flat.h"
+
+ast::FlatTree::FlatTree(AST* ast)
+{
+	// calls store the index of their prototype so every prototype
+	// needs its index before flattening any body
+
+	for (uint32_t i = 0; auto prototype : ast->prototypes)
+		prototypes_map[prototype] = i++;
+
+	std::vector<NodeId> params;
+
+	for (auto prototype : ast->prototypes)
+	{
+		params.clear();
+
+		for (auto param : prototype->params)
+			params.push_back(flatten(param));
+
+		add_prototype(prototype->name, prototype->type, params, prototype->body ? flatten(prototype->body) : INVALID_NODE);
+	}
+}
+
+ast::NodeId ast::FlatTree::add_node(StmtExprType kind, const Type& type, Symbol name, uint64_t value)
+{
+	const auto id = static_cast<NodeId>(kinds.size());
+
+	kinds.push_back(static_cast<uint8_t>(kind));
+	types.push_back(type);
+	symbols.push_back(name);
+	values.push_back(value);
+	ranges.push_back({});
+
+	return id;
+}
+
+uint32_t ast::FlatTree::add_prototype(Symbol name, const Type& type, std::span<const NodeId> params, NodeId body)
+{
+	prototypes.push_back({ name, type, add_children(params), body });
+
+	return static_cast<uint32_t>(prototypes.size() - 1);
+}
+
+ast::FlatRange ast::FlatTree::add_children(std::span<const NodeId> list)
+{
+	const FlatRange range { static_cast<uint32_t>(children.size()), static_cast<uint32_t>(list.size()) };
+
+	children.insert(children.end(), list.begin(), list.end());
+
+	return range;
+}
+
+size_t ast::FlatTree::get_size() const
+{
+	return kinds.size() * sizeof(uint8_t) +
+		   types.size() * sizeof(Type) +
+		   symbols.size() * sizeof(Symbol) +
+		   values.size() * sizeof(uint64_t) +
+		   ranges.size() * sizeof(FlatRange) +
+		   children.size() * sizeof(NodeId) +
+		   prototypes.size() * sizeof(FlatPrototype);
+}
+
+ast::NodeId ast::FlatTree::flatten(Base* root)
+{
+	if (!root)
+		return INVALID_NODE;
+
+	// nodes are taken from an explicit stack so deep trees don't use the
+	// call stack, a node gets its id and reserves its children range before
+	// any of its children so the ids are in pre-order (every child has a
+	// greater id than its parent) and a tree walk visits the columns mostly
+	// in order
+
+	struct Pending
+	{
+		Base* node = nullptr;
+
+		uint32_t slot = 0;
+	};
+
+	static constexpr uint32_t ROOT_SLOT = std::numeric_limits<uint32_t>::max();
+
+	std::vector<Pending> pending { { root, ROOT_SLOT } };
+	std::vector<Base*> list;
+
+	NodeId root_id = INVALID_NODE;
+
+	while (!pending.empty())
+	{
+		const auto [node, slot] = pending.back();
+
+		pending.pop_back();
+
+		auto expr = rtti::cast<Expr>(node);
+
+		const auto id = expr ? add_node(node->stmt_type, expr->type, expr->name) : add_node(node->stmt_type);
+
+		if (slot == ROOT_SLOT)
+			root_id = id;
+		else children[slot] = id;
+
+		list.clear();
+
+		switch (node->stmt_type)
+		{
+		case StmtExpr_IntLiteral:
+		{
+			values[id] = static_cast<ExprIntLiteral*>(node)->integer.u64;
+			break;
+		}
+		case StmtExpr_Id:
+			break;
+		case StmtExpr_Decl:
+		{
+			list = { expr->rhs };
+			break;
+		}
+		case StmtExpr_Assign:
+		{
+			list = { expr->lhs, expr->rhs };
+			break;
+		}
+		case StmtExpr_BinAssign:
+		{
+			values[id] = static_cast<ExprBinaryAssign*>(node)->op;
+			list = { expr->lhs, expr->rhs };
+			break;
+		}
+		case StmtExpr_BinOp:
+		{
+			values[id] = static_cast<ExprBinaryOp*>(node)->op;
+			list = { expr->lhs, expr->rhs };
+			break;
+		}
+		case StmtExpr_UnaryOp:
+		{
+			values[id] = static_cast<ExprUnaryOp*>(node)->op;
+			list = { expr->lhs, expr->rhs };
+			break;
+		}
+		case StmtExpr_Call:
+		{
+			auto call = static_cast<ExprCall*>(node);
+
+			if (auto it = prototypes_map.find(call->prototype); it != prototypes_map.end())
+				values[id] = it->second;
+			else values[id] = INVALID_NODE;
+
+			list.assign(call->exprs.begin(), call->exprs.end());
+			break;
+		}
+		case StmtExpr_Cast:
+		{
+			values[id] = static_cast<ExprCast*>(node)->implicit;
+			list = { expr->rhs };
+			break;
+		}
+		case Stmt_Body:
+		{
+			const auto& stmts = static_cast<StmtBody*>(node)->stmts;
+
+			list.assign(stmts.begin(), stmts.end());
+			break;
+		}
+		case Stmt_If:
+		{
+			auto stmt_if = static_cast<StmtIf*>(node);
+
+			list = { stmt_if->expr, stmt_if->if_body, stmt_if->else_body };
+			list.insert(list.end(), stmt_if->ifs.begin(), stmt_if->ifs.end());
+			break;
+		}
+		case Stmt_For:
+		{
+			auto stmt_for = static_cast<StmtFor*>(node);
+
+			list = { stmt_for->init, stmt_for->condition, stmt_for->step, stmt_for->body };
+			break;
+		}
+		case Stmt_While:
+		{
+			auto stmt_while = static_cast<StmtWhile*>(node);
+
+			list = { stmt_while->condition, stmt_while->body };
+			break;
+		}
+		case Stmt_DoWhile:
+		{
+			auto stmt_do_while = static_cast<StmtDoWhile*>(node);
+
+			list = { stmt_do_while->condition, stmt_do_while->body };
+			break;
+		}
+		case Stmt_Return:
+		{
+			list = { static_cast<StmtReturn*>(node)->expr };
+			break;
+		}
+		}
+
+		// the range is filled as the children get their ids, the first
+		// child is pushed last so it's the next node to be flattened
+
+		const auto range = ranges[id] = FlatRange { static_cast<uint32_t>(children.size()), static_cast<uint32_t>(list.size()) };
+
+		children.resize(children.size() + list.size(), INVALID_NODE);
+
+		for (auto i = range.count; i-- > 0;)
+			if (list[i])
+				pending.push_back({ list[i], range.begin + i });
+	}
+
+	return root_id;
+}
+
+void ast::FlatTree::expand(AST* ast) const
+{
+	// every prototype is created first so calls can link to the ones
+	// defined after them
+
+	std::vector<Prototype*> ast_prototypes;
+
+	ast_prototypes.reserve(prototypes.size());
+
+	for (const auto& prototype : prototypes)
+		ast_prototypes.push_back(ast->arena.create<Prototype>(prototype.name, prototype.type));
+
+	// children always have greater ids than their parent so creating the
+	// nodes from the last id to the first one builds every child before
+	// the node that takes it, no matter how deep the tree is
+
+	std::vector<Base*> nodes(get_nodes_count());
+
+	for (auto id = static_cast<NodeId>(nodes.size()); id-- > 0;)
+		nodes[id] = expand(id, ast, ast_prototypes, nodes);
+
+	auto get_node = [&](NodeId id) { return (id == INVALID_NODE ? nullptr : nodes[id]); };
+
+	for (size_t i = 0; i < prototypes.size(); ++i)
+	{
+		auto prototype = ast_prototypes[i];
+
+		for (auto param : get_children(prototypes[i].params))
+			prototype->params.push_back(static_cast<Expr*>(get_node(param)));
+
+		prototype->body = static_cast<StmtBody*>(get_node(prototypes[i].body));
+	}
+
+	ast->prototypes.insert(ast->prototypes.end(), ast_prototypes.begin(), ast_prototypes.end());
+}
+
+ast::Base* ast::FlatTree::expand(NodeId id, AST* ast, const std::vector<Prototype*>& ast_prototypes, const std::vector<Base*>& nodes) const
+{
+	auto child = [&](uint32_t i)
+	{
+		const auto child_id = get_child(id, i);
+
+		return (child_id == INVALID_NODE ? nullptr : nodes[child_id]);
+	};
+
+	auto expr_child = [&](uint32_t i) { return static_cast<Expr*>(child(i)); };
+	auto body_child = [&](uint32_t i) { return static_cast<StmtBody*>(child(i)); };
+
+	const auto kind = get_kind(id);
+	const auto& type = get_type(id);
+	const auto name = get_symbol(id);
+	const auto value = get_value(id);
+
+	Base* node = nullptr;
+
+	switch (kind)
+	{
+	case StmtExpr_IntLiteral:
+	{
+		Int integer;
+
+		integer.u64 = value;
+
+		node = ast->arena.create<ExprIntLiteral>(integer, type);
+		break;
+	}
+	case StmtExpr_Id:			node = ast->arena.create<ExprId>(name); break;
+	case StmtExpr_Decl:			node = ast->arena.create<ExprDecl>(name, type, expr_child(0)); break;
+	case StmtExpr_Assign:		node = ast->arena.create<ExprAssign>(expr_child(0), expr_child(1)); break;
+	case StmtExpr_BinAssign:	node = ast->arena.create<ExprBinaryAssign>(expr_child(0), expr_child(1), static_cast<BinOpType>(value)); break;
+	case StmtExpr_BinOp:		node = ast->arena.create<ExprBinaryOp>(expr_child(0), expr_child(1), static_cast<BinOpType>(value), type); break;
+	case StmtExpr_UnaryOp:
+	{
+		// only one side is set and it tells where the operator was
+
+		const bool on_left = get_child(id, 0) != INVALID_NODE;
+
+		node = ast->arena.create<ExprUnaryOp>(expr_child(on_left ? 0 : 1), static_cast<UnaryOpType>(value), on_left);
+		break;
+	}
+	case StmtExpr_Call:
+	{
+		auto call = ast->arena.create<ExprCall>(name);
+
+		call->intrinsic = g_intrin->is_intrinsic(name);
+
+		if (value < ast_prototypes.size())
+			call->prototype = ast_prototypes[value];
+
+		for (uint32_t i = 0; i < ranges[id].count; ++i)
+			call->exprs.push_back(expr_child(i));
+
+		node = call;
+		break;
+	}
+	case StmtExpr_Cast:			node = ast->arena.create<ExprCast>(expr_child(0), type, value != 0); break;
+	case Stmt_Body:
+	{
+		auto body = ast->arena.create<StmtBody>();
+
+		for (uint32_t i = 0; i < ranges[id].count; ++i)
+			body->stmts.push_back(child(i));
+
+		node = body;
+		break;
+	}
+	case Stmt_If:
+	{
+		auto stmt_if = ast->arena.create<StmtIf>(expr_child(0), body_child(1));
+
+		stmt_if->else_body = body_child(2);
+
+		for (uint32_t i = 3; i < ranges[id].count; ++i)
+			stmt_if->ifs.push_back(static_cast<StmtIf*>(child(i)));
+
+		node = stmt_if;
+		break;
+	}
+	case Stmt_For:				node = ast->arena.create<StmtFor>(expr_child(1), child(0), child(2), body_child(3)); break;
+	case Stmt_While:			node = ast->arena.create<StmtWhile>(expr_child(0), body_child(1)); break;
+	case Stmt_DoWhile:			node = ast->arena.create<StmtDoWhile>(expr_child(0), body_child(1)); break;
+	case Stmt_Break:			node = ast->arena.create<StmtBreak>(); break;
+	case Stmt_Continue:			node = ast->arena.create<StmtContinue>(); break;
+	case Stmt_Return:			node = ast->arena.create<StmtReturn>(expr_child(0)); break;
+	default:
+		global_error("Invalid node kind {} in flat tree", static_cast<int>(kind));
+	}
+
+	// the constructors of some nodes derive the type from their children
+	// so the stored one is restored to keep the tree as it was
+
+	if (auto expr = rtti::cast<Expr>(node))
+		expr->type = type;
+
+	return node;
+}
+
+namespace ast::flat_io
+{
+	static constexpr uint32_t MAGIC = 0x544b4e41;	// 'ANKT'
+
+	template <typename T>
+	void write(std::string& out, const T& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+	}
+
+	template <typename T>
+	void write(std::string& out, const std::vector<T>& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		write(out, static_cast<uint32_t>(v.size()));
+
+		out.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+	}
+
+	template <typename T>
+	bool read(std::string_view& in, T& v)
+	{
+		if (in.size() < sizeof(T))
+			return false;
+
+		std::memcpy(&v, in.data(), sizeof(T));
+
+		in.remove_prefix(sizeof(T));
+
+		return true;
+	}
+
+	template <typename T>
+	bool read(std::string_view& in, std::vector<T>& v)
+	{
+		uint32_t count = 0;
+
+		if (!read(in, count) || in.size() / sizeof(T) < count)
+			return false;
+
+		v.resize(count);
+
+		std::memcpy(v.data(), in.data(), count * sizeof(T));
+
+		in.remove_prefix(count * sizeof(T));
+
+		return true;
+	}
+}
+
+void ast::FlatTree::serialize(std::string& out) const
+{
+	using namespace flat_io;
+
+	// symbols are renumbered densely in order of appearance and their
+	// text is stored once at the end
+
+	std::unordered_map<uint32_t, uint32_t> symbols_map;
+	std::vector<std::string_view> symbols_text;
+
+	auto remap = [&](Symbol symbol)
+	{
+		if (!symbol.is_valid())
+			return symbol;
+
+		auto [it, inserted] = symbols_map.insert({ symbol.id, static_cast<uint32_t>(symbols_text.size()) });
+
+		if (inserted)
+			symbols_text.push_back(symbol.str());
+
+		return Symbol(it->second);
+	};
+
+	auto local_symbols = symbols;
+	auto local_prototypes = prototypes;
+
+	for (auto& symbol : local_symbols)			symbol = remap(symbol);
+	for (auto& prototype : local_prototypes)	prototype.name = remap(prototype.name);
+
+	out.reserve(out.size() + get_size());
+
+	write(out, MAGIC);
+	write(out, kinds);
+	write(out, types);
+	write(out, local_symbols);
+	write(out, values);
+	write(out, ranges);
+	write(out, children);
+	write(out, local_prototypes);
+	write(out, static_cast<uint32_t>(symbols_text.size()));
+
+	for (auto text : symbols_text)
+	{
+		write(out, static_cast<uint32_t>(text.size()));
+
+		out.append(text);
+	}
+}
+
+bool ast::FlatTree::deserialize(std::string_view in)
+{
+	using namespace flat_io;
+
+	uint32_t magic = 0,
+			 symbols_count = 0;
+
+	if (!read(in, magic) || magic != MAGIC ||
+		!read(in, kinds) || !read(in, types) || !read(in, symbols) || !read(in, values) ||
+		!read(in, ranges) || !read(in, children) || !read(in, prototypes) ||
+		!read(in, symbols_count))
+		return false;
+
+	std::vector<Symbol> symbols_map;
+
+	// every symbol takes at least its size so a bad count can't reserve
+	// more than the file could hold
+
+	symbols_map.reserve(std::min<size_t>(symbols_count, in.size() / sizeof(uint32_t)));
+
+	for (uint32_t i = 0; i < symbols_count; ++i)
+	{
+		uint32_t size = 0;
+
+		if (!read(in, size) || in.size() < size)
+			return false;
+
+		symbols_map.push_back(g_symbols->intern(in.substr(0, size)));
+
+		in.remove_prefix(size);
+	}
+
+	// the columns must be consistent before anything indexes them and the
+	// nodes must be the tree flatten would build (known kinds, the children
+	// layout of their kind and pre-order ids) so expanding a truncated,
+	// stale or corrupted file can't fail, it's simply rejected
+
+	const auto nodes_count = kinds.size();
+
+	if (types.size() != nodes_count || symbols.size() != nodes_count || values.size() != nodes_count || ranges.size() != nodes_count)
+		return false;
+
+	auto remap_symbol = [&](Symbol& symbol)
+	{
+		if (!symbol.is_valid())
+			return true;
+
+		if (symbol.id >= symbols_map.size())
+			return false;
+
+		symbol = symbols_map[symbol.id];
+
+		return true;
+	};
+
+	auto valid_range = [&](FlatRange range, NodeId parent)
+	{
+		if (range.begin > children.size() || range.count > children.size() - range.begin)
+			return false;
+
+		return std::ranges::all_of(get_children(range), [&](NodeId id)
+		{
+			return id == INVALID_NODE || ((parent == INVALID_NODE || id > parent) && id < nodes_count);
+		});
+	};
+
+	auto valid_children_count = [&](NodeId id)
+	{
+		const auto count = ranges[id].count;
+
+		switch (get_kind(id))
+		{
+		case StmtExpr_IntLiteral:
+		case StmtExpr_Id:
+		case Stmt_Break:
+		case Stmt_Continue:			return count == 0;
+		case StmtExpr_Decl:
+		case StmtExpr_Cast:
+		case Stmt_Return:			return count == 1;
+		case StmtExpr_Assign:
+		case StmtExpr_BinAssign:
+		case StmtExpr_BinOp:
+		case Stmt_While:
+		case Stmt_DoWhile:			return count == 2;
+		case StmtExpr_UnaryOp:		return count == 2 && ((get_child(id, 0) == INVALID_NODE) != (get_child(id, 1) == INVALID_NODE));
+		case Stmt_For:				return count == 4;
+		case Stmt_If:				return count >= 3;
+		case StmtExpr_Call:
+		case Stmt_Body:				return true;
+		}
+
+		return false;
+	};
+
+	for (NodeId i = 0; i < nodes_count; ++i)
+		if (kinds[i] >= Stmt_End || !g_types->is_valid(types[i]) || !remap_symbol(symbols[i]) || !valid_range(ranges[i], i) || !valid_children_count(i))
+			return false;
+
+	for (auto& prototype : prototypes)
+		if (!g_types->is_valid(prototype.type) || !remap_symbol(prototype.name) || !valid_range(prototype.params, INVALID_NODE) ||
+			(prototype.body != INVALID_NODE && (prototype.body >= nodes_count || get_kind(prototype.body) != Stmt_Body)))
+			return false;
+
+	return true;
+}
+
+void ast::FlatPrinter::print(const FlatTree* tree)
+{
+	this->tree = tree;
+
+	PRINT_NL;
+
+	for (const auto& prototype : tree->get_prototypes()) print_prototype(prototype);
+}
+
+void ast::FlatPrinter::print_prototype(const FlatPrototype& prototype)
+{
+	if (first_prototype_printed)
+		PRINT_NL;
+
+	PRINT_TABS(White, 0, "prototype '{}'", prototype.name.str());
+
+	if (prototype.params.count > 0)
+	{
+		PRINT_TABS(White, 0, " | arguments: ");
+
+		const auto params = tree->get_children(prototype.params);
+
+		print_vec_int<NodeId>(Green, std::vector<NodeId>(params.begin(), params.end()), ", ", [&](NodeId id)
+		{
+			return tree->get_type(id).str() + " " + std::string(tree->get_symbol(id).str());
+		});
+	}
+
+	if (prototype.is_decl())
+	{
+		PRINT_TABS_NL(White, 0, " (decl)");
+	}
+	else
+	{
+		PRINT_NL;
+
+		print_stmt(prototype.body);
+
+		PRINT_TABS_NL(White, curr_level, "end");
+	}
+
+	first_prototype_printed = true;
+}
+
+void ast::FlatPrinter::print_stmt(NodeId id)
+{
+	// same frames as the pointer tree printer, see Printer::print_stmt
+
+	const auto base = frames.size();
+
+	open_stmt(id);
+
+	while (frames.size() > base)
+	{
+		const auto frame = frames.back();
+
+		++frames.back().step;
+
+		bool done = true;
+
+		switch (tree->get_kind(frame.id))
+		{
+		case Stmt_Body:		done = print_body(frame.id, frame.step); break;
+		case Stmt_If:		done = print_if(frame.id, frame.step); break;
+		case Stmt_For:		done = print_for(frame.id, frame.step); break;
+		case Stmt_While:	done = print_while(frame.id, frame.step); break;
+		case Stmt_DoWhile:	done = print_do_while(frame.id, frame.step); break;
+		default:			break;
+		}
+
+		if (done)
+			frames.pop_back();
+	}
+}
+
+void ast::FlatPrinter::open_stmt(NodeId id)
+{
+	if (id == INVALID_NODE)
+		return;
+
+	switch (const auto kind = tree->get_kind(id))
+	{
+	case Stmt_Body:
+	case Stmt_If:
+	case Stmt_For:
+	case Stmt_While:
+	case Stmt_DoWhile:	frames.push_back({ id }); break;
+	case Stmt_Break:	print_break(id); break;
+	case Stmt_Continue:	print_continue(id); break;
+	case Stmt_Return:	print_return(id); break;
+	default:
+		if (FlatTree::is_expr(kind))
+			print_expr(id);
+	}
+}
+
+bool ast::FlatPrinter::print_body(NodeId id, uint32_t step)
+{
+	const auto stmts = tree->get_children(id);
+
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Cyan, curr_level, "body");
+	}
+	else if (step <= stmts.size())
+		open_stmt(stmts[step - 1]);
+	else
+	{
+		PRINT_TABS_NL(Cyan, curr_level, "end");
+
+		--curr_level;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool ast::FlatPrinter::print_if(NodeId id, uint32_t step)
+{
+	const auto children = tree->get_children(id);
+	const auto else_ifs = children.subspan(3);
+
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "if");
+
+		print_expr(children[0]);
+		open_stmt(children[1]);
+	}
+	else if (step <= else_ifs.size())
+	{
+		const auto else_if = else_ifs[step - 1];
+
+		PRINT_TABS_NL(Blue, curr_level, "else if");
+
+		print_expr(tree->get_child(else_if, 0));
+		open_stmt(tree->get_child(else_if, 1));
+	}
+	else if (step == else_ifs.size() + 1)
+	{
+		if (children[2] != INVALID_NODE)
+		{
+			PRINT_TABS_NL(Blue, curr_level, "else");
+
+			open_stmt(children[2]);
+		}
+	}
+	else
+	{
+		--curr_level;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool ast::FlatPrinter::print_for(NodeId id, uint32_t step)
+{
+	switch (step)
+	{
+	case 0:
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "for");
+
+		open_stmt(tree->get_child(id, 0));
+
+		return false;
+	}
+	case 1:
+	{
+		print_expr(tree->get_child(id, 1));
+		open_stmt(tree->get_child(id, 2));
+
+		return false;
+	}
+	case 2:
+	{
+		open_stmt(tree->get_child(id, 3));
+
+		return false;
+	}
+	}
+
+	--curr_level;
+
+	return true;
+}
+
+bool ast::FlatPrinter::print_while(NodeId id, uint32_t step)
+{
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "while");
+
+		print_expr(tree->get_child(id, 0));
+		open_stmt(tree->get_child(id, 1));
+
+		return false;
+	}
+
+	--curr_level;
+
+	return true;
+}
+
+bool ast::FlatPrinter::print_do_while(NodeId id, uint32_t step)
+{
+	if (step == 0)
+	{
+		++curr_level;
+
+		PRINT_TABS_NL(Blue, curr_level, "do");
+
+		open_stmt(tree->get_child(id, 1));
+
+		return false;
+	}
+
+	PRINT_TABS_NL(Blue, curr_level, "while");
+
+	print_expr(tree->get_child(id, 0));
+
+	--curr_level;
+
+	return true;
+}
+
+void ast::FlatPrinter::print_break(NodeId id)
+{
+	++curr_level;
+
+	PRINT_TABS_NL(Blue, curr_level, "break");
+
+	--curr_level;
+}
+
+void ast::FlatPrinter::print_continue(NodeId id)
+{
+	++curr_level;
+
+	PRINT_TABS_NL(Blue, curr_level, "continue");
+
+	--curr_level;
+}
+
+void ast::FlatPrinter::print_return(NodeId id)
+{
+	PRINT_TABS_NL(Blue, curr_level, "return");
+
+	print_expr(tree->get_child(id, 0));
+}
+
+void ast::FlatPrinter::print_expr(NodeId id)
+{
+	++curr_level;
+
+	if (id != INVALID_NODE)
+	{
+		switch (tree->get_kind(id))
+		{
+		case StmtExpr_IntLiteral:	print_expr_int(id); break;
+		case StmtExpr_Id:			print_id(id); break;
+		case StmtExpr_Decl:			print_decl(id); break;
+		case StmtExpr_Assign:		print_assign(id); break;
+		case StmtExpr_BinAssign:	print_binary_assign(id); break;
+		case StmtExpr_BinOp:		print_expr_binary_op(id); break;
+		case StmtExpr_UnaryOp:		print_expr_unary_op(id); break;
+		case StmtExpr_Call:			print_expr_call(id); break;
+		case StmtExpr_Cast:			print_cast(id); break;
+		}
+	}
+
+	--curr_level;
+}
+
+void ast::FlatPrinter::print_decl(NodeId id)
+{
+	const auto rhs = tree->get_child(id, 0);
+
+	PRINT_TABS_NL(Yellow, curr_level, "decl.{} ({}) '{}'", rhs != INVALID_NODE ? " assignment" : "", tree->get_type(id).str_full(), tree->get_symbol(id).str());
+
+	if (rhs != INVALID_NODE)
+		print_expr(rhs);
+}
+
+void ast::FlatPrinter::print_assign(NodeId id)
+{
+	PRINT_TABS_NL(Yellow, curr_level, "assignment");
+
+	print_expr(tree->get_child(id, 0));
+	print_expr(tree->get_child(id, 1));
+}
+
+void ast::FlatPrinter::print_binary_assign(NodeId id)
+{
+	PRINT_TABS_NL(Yellow, curr_level, "binary assignment ({})", STRIFY_BIN_OP(static_cast<BinOpType>(tree->get_value(id))));
+
+	print_expr(tree->get_child(id, 0));
+	print_expr(tree->get_child(id, 1));
+}
+
+void ast::FlatPrinter::print_expr_int(NodeId id)
+{
+	const auto& type = tree->get_type(id);
+
+	if (type.is_unsigned())
+	{
+		PRINT_TABS_NL(Yellow, curr_level, "int ({}) '{}'", type.str(), tree->get_value(id));
+	}
+	else
+	{
+		PRINT_TABS_NL(Yellow, curr_level, "int ({}) '{}'", type.str(), static_cast<int64_t>(tree->get_value(id)));
+	}
+}
+
+void ast::FlatPrinter::print_id(NodeId id)
+{
+	PRINT_TABS_NL(Yellow, curr_level, "id ({}) '{}'", tree->get_type(id).str_full(), tree->get_symbol(id).str());
+}
+
+void ast::FlatPrinter::print_expr_unary_op(NodeId id)
+{
+	const auto lhs = tree->get_child(id, 0);
+
+	PRINT_TABS_NL(Yellow, curr_level, "unary op {} ({})", lhs != INVALID_NODE ? "on left side" : "on right side", STRIFY_UNARY_OP(static_cast<UnaryOpType>(tree->get_value(id))));
+
+	++curr_level;
+
+	print_expr(lhs != INVALID_NODE ? lhs : tree->get_child(id, 1));
+
+	--curr_level;
+}
+
+void ast::FlatPrinter::print_expr_binary_op(NodeId id)
+{
+	PRINT_TABS_NL(Yellow, curr_level, "binary op ({} | {})", STRIFY_BIN_OP(static_cast<BinOpType>(tree->get_value(id))), tree->get_type(id).str_full());
+
+	++curr_level;
+
+	for (auto child : tree->get_children(id))
+		if (child != INVALID_NODE)
+			print_expr(child);
+
+	--curr_level;
+}
+
+void ast::FlatPrinter::print_expr_call(NodeId id)
+{
+	PRINT_TABS_NL(Yellow, curr_level, "prototype call ({})", tree->get_symbol(id).str());
+
+	for (auto param : tree->get_children(id))
+	{
+		if (tree->get_kind(param) == StmtExpr_Call)
+		{
+			++curr_level;
+
+			print_expr_call(param);
+
+			--curr_level;
+		}
+		else
+		{
+			PRINT_TABS_NL(Yellow, curr_level, "param:");
+			print_expr(param);
+		}
+	}
+}
+
+void ast::FlatPrinter::print_cast(NodeId id)
+{
+	const auto rhs = tree->get_child(id, 0);
+
+	PRINT_TABS_NL(Yellow, curr_level, "{} cast {} to {}",
+		tree->get_value(id) ? "implicit" : "explicit",
+		tree->get_type(rhs).str_full(),
+		tree->get_type(id).str_full());
+
+	print_expr(rhs);
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ast.h"
+
+namespace ast
+{
+	using NodeId = uint32_t;
+
+	inline constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+
+	struct FlatRange
+	{
+		uint32_t begin = 0,
+				 count = 0;
+	};
+
+	struct FlatPrototype
+	{
+		Symbol name;
+
+		Type type {};
+
+		FlatRange params;
+
+		NodeId body = INVALID_NODE;
+
+		bool is_decl() const							{ return body == INVALID_NODE; }
+	};
+
+	/*
+	* struct-of-arrays version of the tree, a node is a 32 bits id into dense
+	* columns (kind, type, symbol, value and children range) and the children
+	* of every node are a range of one shared array, types are stored as
+	* their canonical handle
+	*
+	* the children layout is fixed per kind, missing children are INVALID_NODE:
+	*
+	*	decl, cast, return				[rhs]
+	*	assign, bin assign, bin op		[lhs, rhs]
+	*	unary op						[lhs, rhs] (only one of them is set)
+	*	call							[params...]
+	*	body							[stmts...]
+	*	if								[condition, if body, else body, else ifs...]
+	*	for								[init, condition, step, body]
+	*	while, do while					[condition, body]
+	*
+	* the value column holds the literal of int literals, the operator of
+	* unary/binary ops, the prototype index of calls and whether casts are
+	* implicit
+	*
+	* ids are given in pre-order so every child has a greater id than its
+	* parent, flattening and expanding rely on it to walk trees of any depth
+	* without recursion
+	*
+	* the parser and semantic build and annotate the pointer tree, the flat
+	* tree is its compact form, the AST cache serializes it and expands it
+	* back (see ast::Cache) and the printer reads it directly (FlatPrinter)
+	*/
+	class FlatTree
+	{
+	private:
+
+		std::vector<uint8_t> kinds;
+		std::vector<Type> types;
+		std::vector<Symbol> symbols;
+		std::vector<uint64_t> values;
+		std::vector<FlatRange> ranges;
+
+		std::vector<NodeId> children;
+
+		std::vector<FlatPrototype> prototypes;
+
+		std::unordered_map<Prototype*, uint32_t> prototypes_map;
+
+		NodeId flatten(Base* node);
+
+		Base* expand(NodeId id, AST* ast, const std::vector<Prototype*>& ast_prototypes, const std::vector<Base*>& nodes) const;
+
+	public:
+
+		FlatTree() {}
+		FlatTree(AST* ast);
+
+		// builds the pointer tree back into 'ast'
+
+		void expand(AST* ast) const;
+
+		// raw dump of the columns, symbols are stored as text since their
+		// ids are only valid in the symbol table that interned them
+
+		void serialize(std::string& out) const;
+
+		bool deserialize(std::string_view in);
+
+		NodeId add_node(StmtExprType kind, const Type& type = {}, Symbol name = {}, uint64_t value = 0);
+
+		uint32_t add_prototype(Symbol name, const Type& type, std::span<const NodeId> params, NodeId body);
+
+		FlatRange add_children(std::span<const NodeId> list);
+
+		void set_children(NodeId id, std::span<const NodeId> list)	{ ranges[id] = add_children(list); }
+
+		StmtExprType get_kind(NodeId id) const						{ return static_cast<StmtExprType>(kinds[id]); }
+
+		Type get_type(NodeId id) const								{ return types[id]; }
+
+		Symbol get_symbol(NodeId id) const							{ return symbols[id]; }
+
+		uint64_t get_value(NodeId id) const							{ return values[id]; }
+
+		std::span<const NodeId> get_children(FlatRange range) const	{ return { children.data() + range.begin, range.count }; }
+		std::span<const NodeId> get_children(NodeId id) const		{ return get_children(ranges[id]); }
+
+		NodeId get_child(NodeId id, uint32_t i) const
+		{
+			const auto range = ranges[id];
+
+			return (i < range.count ? children[range.begin + i] : INVALID_NODE);
+		}
+
+		const std::vector<FlatPrototype>& get_prototypes() const	{ return prototypes; }
+
+		size_t get_nodes_count() const								{ return kinds.size(); }
+		size_t get_size() const;
+
+		static bool is_expr(StmtExprType kind)						{ return kind > StmtExpr_Begin && kind < StmtExpr_End; }
+	};
+
+	// compound statement being printed (see Printer and PrintFrame)
+
+	struct FlatPrintFrame
+	{
+		NodeId id = INVALID_NODE;
+
+		uint32_t step = 0;
+	};
+
+	struct FlatPrinter
+	{
+		const FlatTree* tree = nullptr;
+
+		std::vector<FlatPrintFrame> frames;
+
+		int curr_level = 0;
+
+		bool first_prototype_printed = false;
+
+		void print(const FlatTree* tree);
+		void print_prototype(const FlatPrototype& prototype);
+		void print_stmt(NodeId id);
+		void open_stmt(NodeId id);
+
+		bool print_body(NodeId id, uint32_t step);
+		bool print_if(NodeId id, uint32_t step);
+		bool print_for(NodeId id, uint32_t step);
+		bool print_while(NodeId id, uint32_t step);
+		bool print_do_while(NodeId id, uint32_t step);
+
+		void print_break(NodeId id);
+		void print_continue(NodeId id);
+		void print_return(NodeId id);
+		void print_expr(NodeId id);
+		void print_decl(NodeId id);
+		void print_assign(NodeId id);
+		void print_binary_assign(NodeId id);
+		void print_expr_int(NodeId id);
+		void print_id(NodeId id);
+		void print_expr_unary_op(NodeId id);
+		void print_expr_binary_op(NodeId id);
+		void print_expr_call(NodeId id);
+		void print_cast(NodeId id);
+	};
+}
@@ -0,0 +1,127 @@
+#include <defs.h>
+
+#include <lexer/lexer.h>
+
+#include "types.h"
+
+namespace ast
+{
+	bool is_signed_base(TypeID base)
+	{
+		switch (base)
+		{
+		case Type_i8:
+		case Type_i16:
+		case Type_i32:
+		case Type_i64:	return true;
+		}
+
+		return false;
+	}
+
+	bool is_unsigned_base(TypeID base)
+	{
+		switch (base)
+		{
+		case Type_u8:
+		case Type_u16:
+		case Type_u32:
+		case Type_u64:	return true;
+		}
+
+		return false;
+	}
+
+	std::optional<size_t> get_base_size(TypeID base)
+	{
+		switch (base)
+		{
+		case Type_Void: return 0ull;
+		case Type_u8:
+		case Type_i8:	return sizeof(int8_t) * 8ull;
+		case Type_u16:
+		case Type_i16:	return sizeof(int16_t) * 8ull;
+		case Type_u32:
+		case Type_i32:	return sizeof(int32_t) * 8ull;
+		case Type_u64:
+		case Type_i64:	return sizeof(int64_t) * 8ull;
+		}
+
+		return {};
+	}
+}
+
+ast::TypeContext::TypeContext()
+{
+	infos.resize(TYPES_COUNT);
+
+	for (uint32_t base = 0; base < BASE_TYPES; ++base)
+		for (int indirection = -1; indirection <= MAX_INDIRECTION; ++indirection)
+		{
+			const auto base_id = static_cast<TypeID>(base);
+			const auto id = make_id(base_id, indirection);
+			const auto base_size = get_base_size(base_id);
+
+			auto& info = infos[id];
+
+			info.base = base_id;
+			info.indirection = indirection;
+			info.is_signed = is_signed_base(base_id);
+			info.is_unsigned = is_unsigned_base(base_id);
+			info.is_arithmetic = info.is_signed || info.is_unsigned;
+			info.pointer = (indirection < MAX_INDIRECTION ? id + 1 : id);
+			info.pointee = (indirection >= 0 ? id - 1 : id);
+
+			if (indirection > 0)
+			{
+				info.size = sizeof(uint64_t) * 8ull;
+				info.valid_size = true;
+			}
+			else if (base_size)
+			{
+				info.size = *base_size;
+				info.valid_size = true;
+			}
+		}
+
+	common_types.resize(BASE_TYPES * BASE_TYPES);
+
+	for (uint32_t lhs = 0; lhs < BASE_TYPES; ++lhs)
+		for (uint32_t rhs = 0; rhs < BASE_TYPES; ++rhs)
+			common_types[lhs * BASE_TYPES + rhs] = compute_common_type(get(Type(static_cast<TypeID>(lhs))), get(Type(static_cast<TypeID>(rhs))));
+
+	// pointers never cast implicitly, any other pair of different types
+	// needs a cast node
+
+	casts.resize(TYPES_COUNT * TYPES_COUNT);
+
+	for (uint32_t from = 0; from < TYPES_COUNT; ++from)
+		for (uint32_t to = 0; to < TYPES_COUNT; ++to)
+		{
+			auto& cast = casts[from * TYPES_COUNT + to];
+
+			if (from == to)															cast = ImplicitCast_None;
+			else if (infos[from].indirection > 0 || infos[to].indirection > 0)		cast = ImplicitCast_Invalid;
+			else																	cast = ImplicitCast_Cast;
+		}
+}
+
+ast::Type ast::TypeContext::compute_common_type(const TypeInfo& lhs, const TypeInfo& rhs) const
+{
+	if (!lhs.is_arithmetic || !rhs.is_arithmetic)
+		return {};
+
+	if (lhs.base == rhs.base)
+		return Type(lhs.base);
+
+	// same signedness takes the biggest type, otherwise the unsigned type
+	// wins unless the signed one is bigger
+
+	if (lhs.is_signed == rhs.is_signed)
+		return Type(lhs.size > rhs.size ? lhs.base : rhs.base);
+
+	const auto& signed_t = (lhs.is_signed ? lhs : rhs),
+			  & unsigned_t = (lhs.is_signed ? rhs : lhs);
+
+	return Type(unsigned_t.size >= signed_t.size ? unsigned_t.base : signed_t.base);
+}
@@ -27,150 +27,78 @@ namespace ast
 		Stmt_Break,
 		Stmt_Continue,
 		Stmt_Return,
+		Stmt_End,
 	};
 
-	struct Type
+	struct TypeInfo
 	{
-		TypeID type = Type_None;
-
-		uint64_t flags = TypeFlag_None;
+		TypeID base = Type_None;
 
 		int indirection = -1;
 
-		Type() {}
-		Type(TypeID type, int indirection = 0) : type(type), indirection(indirection)
-														{ update_signedness(); }
-
-		void update_indirection(const Type& v)			{ indirection = v.indirection; }
-		void update_indirection(int v)					{ indirection = v; }
-		void increase_indirection()						{ ++indirection; }
+		size_t size = 0;
 
-		void set_type(TypeID v)
-		{
-			type = v;
+		uint32_t pointer = 0,
+				 pointee = 0;
 
-			update_signedness();
-		}
-
-		void update_signedness()
-		{
-			switch (type)
-			{
-			case Type_u8:
-			case Type_u16:
-			case Type_u32:
-			case Type_u64:	flags |= TypeFlag_Unsigned;
-			case Type_i8:
-			case Type_i16:
-			case Type_i32:
-			case Type_i64:	flags &= ~TypeFlag_Unsigned;
-			}
-		}
-
-		bool decrease_indirection()						{ return --indirection >= 0; }
-		bool is_unsigned() const						{ return (flags & TypeFlag_Unsigned); }
-		bool is_same_type(const Type& v) const			{ return type == v.type && indirection == v.indirection; }
-		bool is_same_type(TypeID v) const				{ return type == v && !is_pointer(); }
-		bool is_pointer() const							{ return !(indirection == 0); }
-		bool operator == (const Type& v) const			{ return is_same_type(v); }
-		bool operator == (TypeID v) const				{ return is_same_type(v); }
+		bool valid_size = false,
+			 is_signed = false,
+			 is_unsigned = false,
+			 is_arithmetic = false;
+	};
 
-		bool is_arithmetic() const
-		{
-			switch (type)
-			{
-			case Type_u8:
-			case Type_i8:
-			case Type_u16:
-			case Type_i16:
-			case Type_u32:
-			case Type_i32:
-			case Type_u64:
-			case Type_i64:	return true;
-			}
+	enum ImplicitCast : uint8_t
+	{
+		ImplicitCast_None,
+		ImplicitCast_Cast,
+		ImplicitCast_Invalid,
+	};
 
-			return false;
-		}
+	/*
+	* handle to a canonical type of the TypeContext, there's exactly one
+	* handle per type so comparing and hashing types is comparing ids and
+	* copying one is copying 32 bits, the properties of the type live in
+	* its TypeInfo
+	*/
+	struct Type
+	{
+		uint32_t id = 0;
 
-		size_t get_size() const
-		{
-			if (indirection > 0)
-				return sizeof(uint64_t) * 8ull;
+		Type() {}
+		Type(TypeID type, int indirection = 0);
 
-			switch (type)
-			{
-			case Type_Void: return 0ull;
-			case Type_u8:
-			case Type_i8:	return sizeof(int8_t) * 8ull;
-			case Type_u16:
-			case Type_i16:	return sizeof(int16_t) * 8ull;
-			case Type_u32:
-			case Type_i32:	return sizeof(int32_t) * 8ull;
-			case Type_u64:
-			case Type_i64:	return sizeof(int64_t) * 8ull;
-			}
+		const TypeInfo& info() const;
 
-			global_error("Invalid type while getting size");
+		TypeID get_base() const							{ return info().base; }
+		int get_indirection() const						{ return info().indirection; }
 
-			return 0;
-		}
+		bool increase_indirection();
+		bool decrease_indirection();
 
-		const Type* normal_implicit_cast(const Type& rhs) const
-		{
-			return (type == rhs.type ? nullptr : this);
-		}
+		bool is_signed() const							{ return info().is_signed; }
+		bool is_unsigned() const						{ return info().is_unsigned; }
+		bool is_arithmetic() const						{ return info().is_arithmetic; }
+		bool is_same_type(const Type& v) const			{ return id == v.id; }
+		bool is_same_type(TypeID v) const				{ return id == Type(v).id; }
+		bool is_pointer() const							{ return get_indirection() != 0; }
+		bool operator == (const Type& v) const			{ return is_same_type(v); }
+		bool operator == (TypeID v) const				{ return is_same_type(v); }
 
-		const Type* binary_implicit_cast(const Type& rhs)
+		size_t get_size() const
 		{
-			auto& lhs = *this;
-
-			auto lhs_type = type;
-			auto rhs_type = rhs.type;
-
-			if (lhs_type == rhs_type)
-				return &lhs;
-
-			const bool lhs_signed = !(lhs.flags & TypeFlag_Unsigned),
-					   rhs_signed = !(rhs.flags & TypeFlag_Unsigned);
+			const auto& v = info();
 
-			if (lhs_signed == rhs_signed)
-			{
-				const auto lhs_size = lhs.get_size(),
-						   rhs_size = rhs.get_size();
-
-				if (lhs_size > rhs_size)	  return &lhs;
-				else if (lhs_size < rhs_size) return &rhs;
-
-				global_error("Invalid sides sizes while casting");
-			}
-			else
-			{
-				const Type* signed_t = nullptr,
-						  * unsigned_t = nullptr;
-
-				if (lhs_signed)
-				{
-					signed_t = &lhs;
-					unsigned_t = &rhs;
-				}
-				else
-				{
-					signed_t = &rhs;
-					unsigned_t = &lhs;
-				}
-
-				if (unsigned_t->get_size() >= signed_t->get_size()) return unsigned_t;
-				else												return signed_t;
-			}
+			if (!v.valid_size)
+				global_error("Invalid type while getting size");
 
-			return &lhs;
+			return v.size;
 		}
 
 		ir::Type to_ir_type(int indirection = 0) const
 		{
 			TypeID new_type;
 
-			switch (type)
+			switch (get_base())
 			{
 			case Token_Void:	new_type = Type_Void; break;
 			case Token_U8:
@@ -183,28 +111,117 @@ namespace ast
 			case Token_I64:		new_type = Type_i64;  break;
 			}
 
-			return ir::Type(new_type, this->indirection + indirection);
+			return ir::Type(new_type, get_indirection() + indirection);
 		}
 
 		std::string indirection_str() const
 		{
+			const auto indirection = get_indirection();
+
 			if (indirection <= 0)
 				return {};
 
-			std::string str;
+			return std::string(indirection, '*');
+		}
 
-			str.resize(indirection);
+		std::string str() const							{ return STRIFY_TYPE(get_base()); }
+		std::string str_ir() const						{ return STRIFY_TYPE_IR(get_base()); }
+		std::string str_full() const					{ return str() + indirection_str(); }
+		std::string str_full_ir() const					{ return str_ir() + indirection_str(); }
+	};
 
-			std::fill_n(str.begin(), indirection, '*');
+	/*
+	* owns every type of a compilation, a base type with a number of
+	* indirections has a fixed id (no lookup needed to make one) and all
+	* of them are built up front along with the common type and the
+	* implicit cast of every pair so the hot checks are a table load,
+	* the table is never written after construction so any thread can
+	* read it
+	*
+	* arrays, structs and vectors will get their ids after these ones
+	*/
+	class TypeContext
+	{
+	public:
+
+		static constexpr int MAX_INDIRECTION = 15;
+
+		static constexpr uint32_t INDIRECTION_SLOTS = MAX_INDIRECTION + 2,
+								  BASE_TYPES = Type_u64 + 1,
+								  TYPES_COUNT = BASE_TYPES * INDIRECTION_SLOTS;
 
-			return str;
+		// the slot 0 of every base is indirection -1 so the default
+		// type (none, -1) is the id 0
+
+		static constexpr uint32_t make_id(TypeID base, int indirection)
+		{
+			return static_cast<uint32_t>(base) * INDIRECTION_SLOTS + static_cast<uint32_t>(indirection + 1);
 		}
 
-		std::string str() const							{ return STRIFY_TYPE(type); }
-		std::string str_ir() const						{ return STRIFY_TYPE_IR(type); }
-		std::string str_full() const					{ return str() + indirection_str(); }
-		std::string str_full_ir() const					{ return str_ir() + indirection_str(); }
+	private:
+
+		std::vector<TypeInfo> infos;
+
+		// common types are indexed by the pair of base types (only values
+		// have one) and implicit casts by the pair of type ids
+
+		std::vector<Type> common_types;
+		std::vector<ImplicitCast> casts;
+
+		Type compute_common_type(const TypeInfo& lhs, const TypeInfo& rhs) const;
+
+	public:
+
+		TypeContext();
+
+		const TypeInfo& get(Type type) const			{ return infos[type.id]; }
+
+		bool is_valid(Type type) const					{ return type.id < infos.size(); }
+
+		Type get_common_type(Type lhs, Type rhs) const
+		{
+			return common_types[get(lhs).base * BASE_TYPES + get(rhs).base];
+		}
+
+		ImplicitCast get_implicit_cast(Type from, Type to) const
+		{
+			return casts[from.id * TYPES_COUNT + to.id];
+		}
 	};
 
 	using TypeOpt = std::optional<Type>;
-}
\ No newline at end of file
+}
+
+namespace std
+{
+	template <> struct hash<ast::Type>
+	{
+		size_t operator()(const ast::Type& v) const { return v.id; }
+	};
+}
+
+inline std::unique_ptr<ast::TypeContext> g_types;
+
+inline ast::Type::Type(TypeID type, int indirection) : id(TypeContext::make_id(type, indirection)) {}
+
+inline const ast::TypeInfo& ast::Type::info() const
+{
+	return g_types->get(*this);
+}
+
+inline bool ast::Type::increase_indirection()
+{
+	if (get_indirection() >= TypeContext::MAX_INDIRECTION)
+		return false;
+
+	id = info().pointer;
+
+	return true;
+}
+
+inline bool ast::Type::decrease_indirection()
+{
+	id = info().pointee;
+
+	return get_indirection() >= 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ast.h"
+
+namespace ast
+{
+	/*
+	* set of handlers for a tree walk, one callable per node kind:
+	*
+	*	ast::visit_expr(expr, ast::Visitor
+	*	{
+	*		[&](ExprId* id) { ... },
+	*		[&](ExprCall* call) { ... },
+	*		...
+	*	});
+	*
+	* the visit switches once on stmt_type and calls the handler with the
+	* node already casted, every kind must be handled so a missing handler
+	* doesn't compile, a generic lambda ([](auto) {}) can take the kinds a
+	* pass doesn't care about, a new kind must be added to the kinds lists
+	* and to the switches or the build fails or warns
+	*/
+	template <typename... F>
+	struct Visitor : F...
+	{
+		using F::operator()...;
+	};
+
+	template <typename... F>
+	Visitor(F...) -> Visitor<F...>;
+
+	// one type per node kind, the lists must grow along with StmtExprType
+
+	using ExprKinds = std::tuple<ExprIntLiteral, ExprId, ExprDecl, ExprAssign, ExprBinaryAssign, ExprBinaryOp, ExprUnaryOp, ExprCall, ExprCast>;
+	using StmtKinds = std::tuple<StmtBody, StmtIf, StmtFor, StmtWhile, StmtDoWhile, StmtBreak, StmtContinue, StmtReturn>;
+
+	static_assert(std::tuple_size_v<ExprKinds> == StmtExpr_End - StmtExpr_Begin - 1, "ExprKinds doesn't list every expression kind");
+	static_assert(std::tuple_size_v<StmtKinds> == Stmt_End - StmtExpr_End - 1, "StmtKinds doesn't list every statement kind");
+
+	template <typename V, typename L>
+	inline constexpr bool handles_all_v = false;
+
+	template <typename V, typename... T>
+	inline constexpr bool handles_all_v<V, std::tuple<T...>> = (std::is_invocable_v<V, T*> && ...);
+
+	// expressions, the result of the int literal handler is the result
+	// of the visit and the other handlers must return something convertible,
+	// the switches have no default so a kind they miss is a compiler warning
+
+	template <typename V>
+	auto visit_expr(Expr* expr, V&& visitor)
+	{
+		static_assert(handles_all_v<V, ExprKinds>, "every expression kind needs a handler");
+
+		using R = std::invoke_result_t<V, ExprIntLiteral*>;
+
+		switch (expr->stmt_type)
+		{
+		case StmtExpr_IntLiteral:	return static_cast<R>(visitor(static_cast<ExprIntLiteral*>(expr)));
+		case StmtExpr_Id:			return static_cast<R>(visitor(static_cast<ExprId*>(expr)));
+		case StmtExpr_Decl:			return static_cast<R>(visitor(static_cast<ExprDecl*>(expr)));
+		case StmtExpr_Assign:		return static_cast<R>(visitor(static_cast<ExprAssign*>(expr)));
+		case StmtExpr_BinAssign:	return static_cast<R>(visitor(static_cast<ExprBinaryAssign*>(expr)));
+		case StmtExpr_BinOp:		return static_cast<R>(visitor(static_cast<ExprBinaryOp*>(expr)));
+		case StmtExpr_UnaryOp:		return static_cast<R>(visitor(static_cast<ExprUnaryOp*>(expr)));
+		case StmtExpr_Call:			return static_cast<R>(visitor(static_cast<ExprCall*>(expr)));
+		case StmtExpr_Cast:			return static_cast<R>(visitor(static_cast<ExprCast*>(expr)));
+		case Stmt_None:
+		case StmtExpr:
+		case StmtExpr_Begin:
+		case StmtExpr_End:
+		case Stmt_Body:
+		case Stmt_If:
+		case Stmt_For:
+		case Stmt_While:
+		case Stmt_DoWhile:
+		case Stmt_Break:
+		case Stmt_Continue:
+		case Stmt_Return:
+		case Stmt_End:				break;
+		}
+
+		return R();
+	}
+
+	// statements, expressions used as statements go to the Expr handler
+
+	template <typename V>
+	auto visit_stmt(Base* stmt, V&& visitor)
+	{
+		static_assert(handles_all_v<V, StmtKinds> && std::is_invocable_v<V, Expr*>, "every statement kind needs a handler");
+
+		using R = std::invoke_result_t<V, StmtBody*>;
+
+		switch (stmt->stmt_type)
+		{
+		case Stmt_Body:				return static_cast<R>(visitor(static_cast<StmtBody*>(stmt)));
+		case Stmt_If:				return static_cast<R>(visitor(static_cast<StmtIf*>(stmt)));
+		case Stmt_For:				return static_cast<R>(visitor(static_cast<StmtFor*>(stmt)));
+		case Stmt_While:			return static_cast<R>(visitor(static_cast<StmtWhile*>(stmt)));
+		case Stmt_DoWhile:			return static_cast<R>(visitor(static_cast<StmtDoWhile*>(stmt)));
+		case Stmt_Break:			return static_cast<R>(visitor(static_cast<StmtBreak*>(stmt)));
+		case Stmt_Continue:			return static_cast<R>(visitor(static_cast<StmtContinue*>(stmt)));
+		case Stmt_Return:			return static_cast<R>(visitor(static_cast<StmtReturn*>(stmt)));
+		case StmtExpr_IntLiteral:
+		case StmtExpr_Id:
+		case StmtExpr_Decl:
+		case StmtExpr_Assign:
+		case StmtExpr_BinAssign:
+		case StmtExpr_BinOp:
+		case StmtExpr_UnaryOp:
+		case StmtExpr_Call:
+		case StmtExpr_Cast:			return static_cast<R>(visitor(static_cast<Expr*>(stmt)));
+		case Stmt_None:
+		case StmtExpr:
+		case StmtExpr_Begin:
+		case StmtExpr_End:
+		case Stmt_End:				break;
+		}
+
+		return R();
+	}
+}
\ No newline at end of file
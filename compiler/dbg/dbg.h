@@ -247,6 +247,7 @@ struct TimeProfiling
 {
 	std::chrono::high_resolution_clock::time_point m_start;
 	uint64_t cycles = 0;
+	size_t bytes = 0;
 	std::string name;
 
 	TimeProfiling(const std::string& name) : name(name)
@@ -260,10 +261,14 @@ struct TimeProfiling
 		const auto cycles_passed = __rdtsc() - cycles;
 		const auto time_passed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - m_start).count();
 		make_text_nl(Yellow, "{}: {:.3f} ms | {} mcs | {} cycles", name, static_cast<double>(time_passed) / 1000.f, time_passed, cycles_passed).print();
+
+		if (bytes > 0 && time_passed > 0)
+			make_text_nl(Yellow, "{}: {:.3f} MB/s", name, (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (static_cast<double>(time_passed) / 1000000.0)).print();
 	}
 };
 
 #define PROFILE(x)						TimeProfiling p(x)
+#define PROFILE_BYTES(x)				p.bytes = x
 #define EMPTY_NEW_LINE					White, "\n"
 #define PRINT_NNL(x, y, ...)			make_text(x, y, __VA_ARGS__).print()
 #define PRINT(x, y, ...)				make_text_nl(x, y, __VA_ARGS__).print()
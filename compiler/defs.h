@@ -11,7 +11,8 @@
 #include <stdio.h>
 #include <iomanip>
 #include <chrono>
-#include <regex>
+#include <array>
+#include <string_view>
 #include <set>
 #include <map>
 #include <unordered_set>
@@ -22,8 +23,10 @@
 #include <optional>
 #include <functional>
 #include <future>
+#include <atomic>
 #include <ranges>
 #include <span>
+#include <bit>
 
 using optional_str = std::optional<std::string>;
 
@@ -45,4 +48,6 @@ using optional_str = std::optional<std::string>;
 
 #include <mem/mem.h>
 
+#include <symbol/symbol.h>
+
 using namespace std::chrono_literals;
\ No newline at end of file
@@ -29,13 +29,7 @@ enum TokenFlag : unsigned __int64
 	TokenFlag_Unsigned		= (1ull << 4),
 	TokenFlag_Assignation	= (1ull << 5),
 	TokenFlag_Id			= (1ull << 6),
-};
-
-enum TypeFlag : unsigned __int64
-{
-	TypeFlag_None			= 0ull,
-	TypeFlag_Unsigned		= (1ull << 0),
-	TypeFlag_StaticValue	= (1ull << 1),
+	TokenFlag_StaticValue	= (1ull << 7),
 };
 
 enum BinOpType
@@ -4,10 +4,10 @@
 
 Intrinsic::Intrinsic()
 {
-	intrinsics.insert("__rdtsc");
+	intrinsics.insert(g_symbols->intern("__rdtsc"));
 }
 
-bool Intrinsic::is_intrinsic(const std::string& name)
+bool Intrinsic::is_intrinsic(Symbol name)
 {
 	return intrinsics.contains(name);
 }
\ No newline at end of file
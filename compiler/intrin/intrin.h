@@ -4,13 +4,13 @@ class Intrinsic
 {
 private:
 
-	std::unordered_set<std::string> intrinsics;
+	std::unordered_set<Symbol> intrinsics;
 
 public:
 
 	Intrinsic();
 
-	bool is_intrinsic(const std::string& name);
+	bool is_intrinsic(Symbol name);
 };
 
 inline std::unique_ptr<Intrinsic> g_intrin;
\ No newline at end of file
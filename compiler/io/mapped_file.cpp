@@ -0,0 +1,100 @@
+#include <defs.h>
+
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+
+#ifdef _WIN32
+	file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size {};
+
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		close();
+		return false;
+	}
+
+	// empty files can't be mapped but they are still valid inputs
+
+	if ((size = static_cast<size_t>(file_size.QuadPart)) == 0)
+		return true;
+
+	if (!(mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)))
+	{
+		close();
+		return false;
+	}
+
+	if (!(data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))))
+	{
+		close();
+		return false;
+	}
+#else
+	if ((fd = ::open(filename.c_str(), O_RDONLY)) == -1)
+		return false;
+
+	struct stat file_info {};
+
+	if (fstat(fd, &file_info) == -1)
+	{
+		close();
+		return false;
+	}
+
+	// empty files can't be mapped but they are still valid inputs
+
+	if ((size = static_cast<size_t>(file_info.st_size)) == 0)
+		return true;
+
+	auto mapped_data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped_data == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	madvise(mapped_data, size, MADV_SEQUENTIAL);
+
+	data = static_cast<const char*>(mapped_data);
+#endif
+
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data)								UnmapViewOfFile(data);
+	if (mapping)							CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)		CloseHandle(file);
+
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#else
+	if (data)		munmap(const_cast<char*>(data), size);
+	if (fd != -1)	::close(fd);
+
+	fd = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
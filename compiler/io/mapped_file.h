@@ -0,0 +1,40 @@
+#pragma once
+
+/*
+* read-only view of a whole file mapped into memory, the lexer
+* scans it in place so tokens can point straight into the buffer
+*/
+class MappedFile
+{
+private:
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE,
+		   mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	const char* data = nullptr;
+
+	size_t size = 0;
+
+public:
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	bool open(const std::string& filename);
+
+	void close();
+
+	const char* begin() const			{ return data; }
+	const char* end() const				{ return data + size; }
+
+	size_t get_size() const				{ return size; }
+
+	std::string_view view() const		{ return { data, size }; }
+};
@@ -20,11 +20,11 @@ namespace ir
 {
 	struct Context
 	{
-		std::unordered_map<std::string, Prototype*> prototypes;
+		std::unordered_map<Symbol, Prototype*> prototypes;
 
 		Prototype* pt = nullptr;
 
-		Prototype* find_prototype(const std::string& name)
+		Prototype* find_prototype(Symbol name)
 		{
 			auto it = prototypes.find(name);
 			return it != prototypes.end() ? it->second : nullptr;
@@ -46,6 +46,18 @@ namespace std
 {
 	template <> struct hash<ir::Type>
 	{
-		size_t operator()(const ir::Type& v) const { return (hash<decltype(v.type)>()(v.type) ^ hash<decltype(v.indirection)>()(v.indirection)); }
+		// a plain xor makes pointer chains collide (i8* and i16 are both 3)
+		// so both fields get their own half before mixing
+
+		size_t operator()(const ir::Type& v) const
+		{
+			auto h = (static_cast<uint64_t>(v.type) << 32) | static_cast<uint32_t>(v.indirection);
+
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+
+			return static_cast<size_t>(h);
+		}
 	};
 }
\ No newline at end of file
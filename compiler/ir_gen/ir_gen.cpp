@@ -2,6 +2,7 @@
 
 #include <gv/gv.h>
 #include <syntax/syntax.h>
+#include <ast/visitor.h>
 
 #include "ir_gen.h"
 
@@ -87,9 +88,15 @@ ir::Body* IR::generate_body(ast::StmtBody* ast_body)
 
 	for (auto stmt : ast_body->stmts)
 	{
-		if (auto body = rtti::cast<ast::StmtBody>(stmt))					generate_body(body);
-		else if (auto expr = rtti::cast<ast::Expr>(stmt))					generate_expr(expr);
-		else if (auto stmt_return = rtti::cast<ast::StmtReturn>(stmt))		generate_return(stmt_return);
+		// control flow is not lowered yet, those statements are skipped
+
+		ast::visit_stmt(stmt, ast::Visitor
+		{
+			[&](ast::StmtBody* body)				{ generate_body(body); },
+			[&](ast::Expr* expr)					{ generate_expr(expr); },
+			[&](ast::StmtReturn* stmt_return)		{ generate_return(stmt_return); },
+			[&](auto)								{},
+		});
 	}
 
 	return body;
@@ -97,18 +104,28 @@ ir::Body* IR::generate_body(ast::StmtBody* ast_body)
 
 ir::ItemBase* IR::generate_expr(ast::Expr* expr)
 {
-	if (auto int_literal = rtti::cast<ast::ExprIntLiteral>(expr))			return generate_expr_int_literal(int_literal);
-	else if (auto decl = rtti::cast<ast::ExprDecl>(expr))					return generate_expr_decl(decl);
-	else if (auto assign = rtti::cast<ast::ExprAssign>(expr))				return generate_expr_assign(assign);
-	else if (auto cast = rtti::cast<ast::ExprCast>(expr))					return generate_expr_cast(cast);
-	else if (auto id = rtti::cast<ast::ExprId>(expr))						return generate_expr_id(id);
-	else if (auto bin_op = rtti::cast<ast::ExprBinaryOp>(expr))				return generate_expr_binary_op(bin_op);
-	else if (auto unary_op = rtti::cast<ast::ExprUnaryOp>(expr))			return generate_expr_unary_op(unary_op);
-	else if (auto call = rtti::cast<ast::ExprCall>(expr))					return generate_expr_call(call);
+	auto unsupported = [&]() -> ir::ItemBase*
+	{
+		global_error("Could not generate the IR equivalent of an expression");
 
-	global_error("Could not generate the IR equivalent of an expression");
+		return nullptr;
+	};
 
-	return nullptr;
+	if (!expr)
+		return unsupported();
+
+	return ast::visit_expr(expr, ast::Visitor
+	{
+		[&](ast::ExprIntLiteral* int_literal) -> ir::ItemBase*	{ return generate_expr_int_literal(int_literal); },
+		[&](ast::ExprDecl* decl) -> ir::ItemBase*				{ return generate_expr_decl(decl); },
+		[&](ast::ExprAssign* assign) -> ir::ItemBase*			{ return generate_expr_assign(assign); },
+		[&](ast::ExprCast* cast) -> ir::ItemBase*				{ return generate_expr_cast(cast); },
+		[&](ast::ExprId* id) -> ir::ItemBase*					{ return generate_expr_id(id); },
+		[&](ast::ExprBinaryOp* bin_op) -> ir::ItemBase*			{ return generate_expr_binary_op(bin_op); },
+		[&](ast::ExprUnaryOp* unary_op) -> ir::ItemBase*		{ return generate_expr_unary_op(unary_op); },
+		[&](ast::ExprCall* call) -> ir::ItemBase*				{ return generate_expr_call(call); },
+		[&](ast::ExprBinaryAssign*) -> ir::ItemBase*			{ return unsupported(); },
+	});
 }
 
 ir::ItemBase* IR::generate_expr_int_literal(ast::ExprIntLiteral* expr)
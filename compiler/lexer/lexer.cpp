@@ -2,237 +2,495 @@
 
 #include "lexer.h"
 
-Lexer::~Lexer()
+bool Lexer::run(const std::string& filename, size_t threads)
 {
-	for (auto token : tokens)		_FREE(token);
-	for (auto token : eaten_tokens) _FREE(token);
-}
+	this->filename = filename;
 
-bool Lexer::run(const std::string& filename)
-{
-	// open the input file
+	// map the whole input file, tokens point directly into this buffer
+	// so it's kept alive as long as the lexer
 
-	auto file = std::ifstream(filename);
-	if (!file)
+	if (!source.open(filename))
+	{
+		add_error("{} -> Could not open the file", filename);
 		return false;
+	}
 
-	// parse each line of the input file
+	text = source.view();
 
-	std::string line;
+	// tokens address the source with 32 bits offsets
 
-	auto remove_spaces = [&]()
+	if (text.size() > std::numeric_limits<uint32_t>::max())
 	{
-		if (line.empty())
-			return;
+		add_error("{} -> File is too big", filename);
+		return false;
+	}
 
-		if (line.find_first_not_of("\t ") != std::string::npos)
-			for (auto curr_char = line.at(0); (curr_char == ' ' || curr_char == '\t'); curr_char = line.at(0))
-				line = line.substr(line.find_first_not_of("\t "), std::string::npos);
-		else line.clear();
+	auto add_token_error = [&](const Token& token)
+	{
+		if (token.is_literal())
+			add_error("{} -> Integer literal '{}' overflows {}", get_location_str(&token), get_value(&token), token.to_ast_type().str());
+		else add_error("{} -> Unrecognized token '{}'", get_location_str(&token), get_value(&token));
 	};
 
-	auto strip_line = [&](size_t off, size_t count)
+	// big sources are split in chunks lexed in parallel, every chunk interns
+	// its identifiers in its own table and the tables are merged in order so
+	// symbols get the same ids the serial lexer would give them
+
+	const auto chunks_count = std::clamp<size_t>(text.size() / MIN_CHUNK_SIZE, 1, std::max<size_t>(threads, 1));
+
+	std::vector<Chunk> chunks;
+
+	if (chunks_count > 1)
 	{
-		return (line = line.erase(off, count)).empty();
-	};
-	
-	auto next = [&](size_t off)
+		const auto boundaries = split_source(chunks_count);
+
+		chunks.resize(boundaries.size() - 1);
+
+		for (size_t i = 0; i < chunks.size(); ++i)
+		{
+			auto& chunk = chunks[i];
+
+			chunk.begin = boundaries[i];
+			chunk.end = boundaries[i + 1];
+			chunk.symbols = &chunk.local_symbols;
+		}
+
+		std::vector<std::future<void>> workers;
+
+		for (auto& chunk : chunks)
+			workers.push_back(std::async(std::launch::async, [this, &chunk]() { lex_chunk(chunk); }));
+
+		for (auto& worker : workers)
+			worker.get();
+
+		// the pre-scan doesn't know about invalid tokens so a boundary could
+		// still end up inside a block comment the serial lexer would open,
+		// when that happens the whole source is lexed again serially
+
+		if (std::any_of(chunks.begin(), chunks.end() - 1, [](const Chunk& chunk) { return chunk.open_comment; }))
+			chunks.clear();
+	}
+
+	if (chunks.size() <= 1)
 	{
-		line = line.substr(off, std::string::npos);
-		remove_spaces();
-	};
+		Chunk chunk {};
+
+		chunk.begin = text.data();
+		chunk.end = text.data() + text.size();
+		chunk.symbols = g_symbols.get();
+
+		lex_chunk(chunk);
+
+		tokens = std::move(chunk.tokens);
+		literals = std::move(chunk.literals);
 
-	int line_num = 1,
-		multiline_comment = 0;
+		for (const auto& error_token : chunk.error_tokens)
+			add_token_error(error_token);
 
-	while (std::getline(file, line))
+		return true;
+	}
+
+	// merge the symbols serially and then fix the symbols and literals of
+	// every chunk while copying its tokens to their final place
+
+	size_t tokens_count = 0,
+		   literals_count = 0;
+
+	for (auto& chunk : chunks)
 	{
-		// remove spaces and tabs at the beginning of the line
+		chunk.first_token = tokens_count;
+		chunk.first_literal = literals_count;
+		chunk.symbols_remap.resize(chunk.local_symbols.get_symbols_count());
+
+		for (uint32_t i = 0; i < chunk.symbols_remap.size(); ++i)
+			chunk.symbols_remap[i] = g_symbols->intern(chunk.local_symbols.get(Symbol(i))).id;
+
+		for (const auto& error_token : chunk.error_tokens)
+			add_token_error(error_token);
+
+		tokens_count += chunk.tokens.size();
+		literals_count += chunk.literals.size();
+	}
+
+	tokens.resize(tokens_count);
+	literals.resize(literals_count);
 
-		remove_spaces();
-		
-		while (!line.empty())
+	std::vector<std::future<void>> workers;
+
+	for (auto& chunk : chunks)
+	{
+		workers.push_back(std::async(std::launch::async, [this, &chunk]()
 		{
-			auto multi_comment_begin_pos = line.find("/*"),
-				 multi_comment_end_pos = line.find("*/");
+			auto out = tokens.begin() + chunk.first_token;
 
-			if (multi_comment_begin_pos != std::string::npos &&
-				multi_comment_end_pos != std::string::npos)
-			{
-				if (strip_line(multi_comment_begin_pos, multi_comment_end_pos - multi_comment_begin_pos + 2))
-					break;
-			}
-			else
+			for (auto token : chunk.tokens)
 			{
-				if (multi_comment_end_pos != std::string::npos)
-				{
-					if (--multiline_comment < 0)
-						multiline_comment = 0;
+				if (token.flags & TokenFlag_Id)
+					token.symbol = chunk.symbols_remap[token.symbol];
+				else if (token.is_literal())
+					token.literal += static_cast<uint32_t>(chunk.first_literal);
 
-					if (strip_line(0, multi_comment_end_pos + 2))
-						break;
-				}
-				else if (multi_comment_begin_pos == 0)
-				{
-					++multiline_comment;
-					break;
-				}
+				*out++ = token;
 			}
 
-			if (multiline_comment)
-				break;
+			std::copy(chunk.literals.begin(), chunk.literals.end(), literals.begin() + chunk.first_literal);
+		}));
+	}
+
+	for (auto& worker : workers)
+		worker.get();
+
+	return true;
+}
+
+SourceEdit Lexer::diff(std::string_view new_source) const
+{
+	// common prefix and suffix, the suffix can't overlap the prefix in
+	// either version
+
+	const auto max_prefix = std::min(text.size(), new_source.size());
+
+	const auto prefix = static_cast<size_t>(std::mismatch(text.begin(), text.begin() + max_prefix, new_source.begin()).first - text.begin());
+
+	const auto max_suffix = max_prefix - prefix;
+
+	const auto suffix = static_cast<size_t>(std::mismatch(text.rbegin(), text.rbegin() + max_suffix, new_source.rbegin()).first - text.rbegin());
+
+	return
+	{
+		.begin = static_cast<uint32_t>(prefix),
+		.old_end = static_cast<uint32_t>(text.size() - suffix),
+		.new_end = static_cast<uint32_t>(new_source.size() - suffix),
+	};
+}
+
+std::optional<size_t> Lexer::relex(std::string new_source, const SourceEdit& edit, uint32_t begin, uint32_t end, size_t first_token, size_t last_token)
+{
+	// [begin, end) is the window of the old source holding the tokens
+	// [first_token, last_token) and the whole edit, only the new version
+	// of the window is lexed again and the tokens after it are shifted,
+	// nullopt means the window can't be lexed on its own (or has errors)
+	// and the whole source must be lexed again, the lexer is left as it
+	// was in that case
+
+	if (!errors.empty() || new_source.size() > std::numeric_limits<uint32_t>::max())
+		return {};
+
+	const auto delta = edit.get_delta();
+
+	// the window is lexed against the new source before anything is
+	// replaced, the identifiers go to a table of their own like the
+	// chunks lexed in parallel
+
+	Chunk chunk {};
+
+	chunk.begin = new_source.data() + begin;
+	chunk.end = new_source.data() + end + delta;
+	chunk.symbols = &chunk.local_symbols;
+
+	const auto old_text = std::exchange(text, new_source);
+
+	lex_chunk(chunk);
+
+	text = old_text;
+
+	// a comment still open at the end of the window would hide the
+	// tokens after it
+
+	const auto window = std::string_view(chunk.begin, chunk.end);
+	const auto last_newline = window.rfind('\n');
+	const auto last_line = (last_newline == std::string_view::npos ? window : window.substr(last_newline));
+
+	if (chunk.open_comment || !chunk.error_tokens.empty() || last_line.find("//") != std::string_view::npos)
+		return {};
+
+	// the window is valid, from here on the new version replaces the old
+	// one which is kept until the next edit
+
+	if (last_relex.valid)
+		source.close();
+
+	last_relex.edited = (text.data() == edited_source.data());
+	last_relex.source = std::move(edited_source);
+	last_relex.text = (last_relex.edited ? std::string_view(last_relex.source) : text);
+	last_relex.tokens.assign(tokens.begin() + first_token, tokens.begin() + last_token);
+	last_relex.first_token = first_token;
+	last_relex.new_tokens_count = chunk.tokens.size();
+	last_relex.literals_count = literals.size();
+	last_relex.delta = delta;
+	last_relex.valid = true;
+
+	edited_source = std::move(new_source);
+	text = edited_source;
+
+	// literals of the new tokens go after the existing ones, the old
+	// ones are left unused
+
+	chunk.symbols_remap.resize(chunk.local_symbols.get_symbols_count());
+
+	for (uint32_t i = 0; i < chunk.symbols_remap.size(); ++i)
+		chunk.symbols_remap[i] = g_symbols->intern(chunk.local_symbols.get(Symbol(i))).id;
+
+	for (auto& token : chunk.tokens)
+	{
+		if (token.flags & TokenFlag_Id)
+			token.symbol = chunk.symbols_remap[token.symbol];
+		else if (token.is_literal())
+			token.literal += static_cast<uint32_t>(literals.size());
+	}
+
+	literals.insert(literals.end(), chunk.literals.begin(), chunk.literals.end());
+
+	for (auto it = tokens.begin() + last_token; it != tokens.end(); ++it)
+		it->offset = static_cast<uint32_t>(it->offset + delta);
+
+	const auto old_count = static_cast<ptrdiff_t>(last_token - first_token),
+			   new_count = static_cast<ptrdiff_t>(chunk.tokens.size());
+
+	if (new_count > old_count)
+		tokens.insert(tokens.begin() + last_token, new_count - old_count, Token {});
+	else tokens.erase(tokens.begin() + first_token + new_count, tokens.begin() + last_token);
+
+	std::copy(chunk.tokens.begin(), chunk.tokens.end(), tokens.begin() + first_token);
+
+	line_starts.clear();
+	line_starts_built = std::make_unique<std::once_flag>();
+
+	return chunk.tokens.size();
+}
+
+void Lexer::undo_relex()
+{
+	// puts back the tokens, literals and source the last 'relex' replaced
+
+	if (!last_relex.valid)
+		return;
+
+	const auto first_token = last_relex.first_token,
+			   new_end = first_token + last_relex.new_tokens_count;
+
+	for (auto it = tokens.begin() + new_end; it != tokens.end(); ++it)
+		it->offset = static_cast<uint32_t>(it->offset - last_relex.delta);
+
+	tokens.erase(tokens.begin() + first_token, tokens.begin() + new_end);
+	tokens.insert(tokens.begin() + first_token, last_relex.tokens.begin(), last_relex.tokens.end());
+
+	literals.resize(last_relex.literals_count);
+
+	if (last_relex.edited)
+	{
+		edited_source = std::move(last_relex.source);
+		text = edited_source;
+	}
+	else
+	{
+		edited_source.clear();
+		text = last_relex.text;
+	}
+
+	line_starts.clear();
+	line_starts_built = std::make_unique<std::once_flag>();
+
+	last_relex = {};
+}
+
+std::vector<const char*> Lexer::split_source(size_t count) const
+{
+	// walks the comments of the whole source so boundaries are only
+	// placed right after newlines outside block comments
+
+	const auto begin = text.data(),
+			   end = text.data() + text.size();
+
+	const auto target_size = static_cast<ptrdiff_t>(text.size() / count);
+
+	std::vector<const char*> boundaries { begin };
 
-			std::smatch sm;
+	auto it = begin,
+		 next_target = begin + target_size;
 
-			if (std::regex_search(line, sm, regex::SINGLE_COMMENT) &&
-				line.find(sm.str()) == 0)
+	while (it != end && boundaries.size() < count)
+	{
+		const auto slash_offset = std::string_view(it, end).find('/');
+		const auto slash = (slash_offset == std::string_view::npos ? end : it + slash_offset);
+
+		while (next_target < slash && boundaries.size() < count)
+		{
+			const auto newline = scanner::find_newline(next_target, slash);
+			if (newline == slash || newline + 1 == end)
 				break;
 
-			auto curr_token = _ALLOC(Token);
+			boundaries.push_back(newline + 1);
 
-			size_t token_len = 0;
+			next_target = newline + 1 + target_size;
+		}
 
-			bool valid = false;
+		if (slash == end)
+			break;
 
-			auto check_token_regex = [&](const std::regex& rgx, TokenID token_type)
-			{
-				if (std::regex_search(line, sm, rgx))
-				{
-					if (auto token_found = sm.str(); valid = (line.find(token_found) == 0))
-					{
-						token_len = token_found.length();
-
-						switch (token_type)
-						{
-						case Token_Id:
-						{
-							if (auto it = g_keywords.find(token_found); it != g_keywords.end())
-							{
-								curr_token->value = token_found;
-								curr_token->id = it->second;
-								curr_token->flags |= TokenFlag_Keyword;
-							}
-							else if (auto it_decl = g_keywords_type.find(token_found); it_decl != g_keywords_type.end())
-							{
-								curr_token->value = token_found;
-								curr_token->id = std::get<0>(it_decl->second);
-								curr_token->flags |= TokenFlag_KeywordType | std::get<2>(it_decl->second);
-							}
-							else if (auto it_static_val = g_static_values.find(token_found); it_static_val != g_static_values.end())
-							{
-								switch (it_static_val->second)
-								{
-								case Token_U8:
-								{
-									curr_token->value = token_found == "true" ? "1" : "0";
-									curr_token->id = Token_U8;
-									curr_token->flags |= TokenFlag_Unsigned;
-									break;
-								}
-								}
-							}
-							else
-							{
-								curr_token->value = token_found;
-								curr_token->id = token_type;
-								curr_token->flags |= TokenFlag_Id;
-							}
-
-							break;
-						}
-						case Token_IntLiteral:
-						{
-							curr_token->id = token_type;
-
-							const auto int_group = sm[1],
-									   unsigned_group = sm[3],
-									   size_group = sm[4];
-
-							if (unsigned_group.matched && size_group.matched)
-							{
-								const bool is_unsigned = unsigned_group.str() == "u";
-
-								curr_token->flags |= is_unsigned ? TokenFlag_Unsigned : 0;
-
-								switch (std::stoll(size_group))
-								{
-								case 0:		curr_token->id = Token_Void; break;
-								case 8:		curr_token->id = is_unsigned ? Token_U8  : Token_I8;   break;
-								case 16:	curr_token->id = is_unsigned ? Token_U16 : Token_I16;  break;
-								case 32:	curr_token->id = is_unsigned ? Token_U32 : Token_I32;  break;
-								case 64:	curr_token->id = is_unsigned ? Token_U64 : Token_I64;  break;
-								}
-							}
-							else curr_token->id = Token_I32;
-
-							curr_token->value = token_found;
-
-							break;
-						}
-						}
-
-						return true;
-					}
-				}
+		const auto next = (slash + 1 == end ? '\0' : *(slash + 1));
 
-				return false;
-			};
+		if (next == '/')
+			it = scanner::find_newline(slash + 2, end);
+		else if (next == '*')
+		{
+			const auto comment_end = scanner::find_comment_end(slash + 2, end);
 
-			check_token_regex(regex::INT_LITERAL, Token_IntLiteral);
+			it = (comment_end == end ? end : comment_end + 2);
+		}
+		else it = slash + 1;
 
-			for (const auto& token : g_static_tokens)
-			{
-				const auto len = token.value.length();
+		next_target = std::max(next_target, it);
+	}
 
-				if (!line.compare(0, len, token.value))
-				{
-					*curr_token = token;
-					valid = true;
-					token_len = len;
-					break;
-				}
-			}
+	boundaries.push_back(end);
 
-			if (!valid)
-				check_token_regex(regex::WORD, Token_Id);
+	return boundaries;
+}
 
-			if (valid)
-			{
-				curr_token->line = line_num;
+void Lexer::lex_chunk(Chunk& chunk) const
+{
+	auto it = chunk.begin,
+		 end = chunk.end;
+
+	auto is_separator = [](char c)
+	{
+		return (scanner::is_space(c) || c == '\r' || c == '\n');
+	};
+
+	// lines are not tracked here, they are resolved from the token
+	// offsets only when a diagnostic needs them (see Lexer::get_location)
+
+	while (it != end)
+	{
+		const auto c = *it;
 
-				tokens.push_back(curr_token);
+		if (is_separator(c))
+		{
+			it = scanner::skip_blanks(it + 1, end);
+			continue;
+		}
+
+		const auto str = std::string_view(it, end);
+
+		// skip comments directly in the buffer
+
+		if (str.starts_with("//"))
+		{
+			it = scanner::find_newline(it + 2, end);
+			continue;
+		}
+
+		if (str.starts_with("/*"))
+		{
+			const auto comment_end = scanner::find_comment_end(it + 2, end);
+
+			chunk.open_comment = (comment_end == end);
+
+			it = (comment_end == end ? end : comment_end + 2);
+
+			continue;
+		}
+
+		Token curr_token {};
 
-				next(token_len);
+		size_t token_len = 0;
+
+		bool valid = false,
+			 overflow = false;
+
+		// dispatch on the first character, identifiers and int literals
+		// are scanned by hand and everything else is a static token
+
+		if (scanner::is_digit(c))
+		{
+			const auto literal = scanner::scan_int_literal(str);
+
+			curr_token.flags |= literal.is_unsigned ? TokenFlag_Unsigned : 0;
+
+			switch (literal.size)
+			{
+			case 8:		curr_token.id = literal.is_unsigned ? Token_U8  : Token_I8;   break;
+			case 16:	curr_token.id = literal.is_unsigned ? Token_U16 : Token_I16;  break;
+			case 32:	curr_token.id = literal.is_unsigned ? Token_U32 : Token_I32;  break;
+			case 64:	curr_token.id = literal.is_unsigned ? Token_U64 : Token_I64;  break;
 			}
-			else
+
+			curr_token.literal = static_cast<uint32_t>(chunk.literals.size());
+			chunk.literals.push_back(Int { literal.value });
+
+			token_len = literal.length;
+			overflow = literal.overflow;
+			valid = true;
+		}
+		else if (scanner::is_id_begin(c))
+		{
+			token_len = scanner::scan_id(str);
+
+			const auto token_found = str.substr(0, token_len);
+
+			if (auto reserved_word = scanner::find_reserved_word(token_found))
 			{
-				auto invalid_token = line;
-				
-				if (auto next_space = invalid_token.find_first_of("\t "); next_space != std::string::npos)
+				curr_token.id = reserved_word->id;
+				curr_token.flags |= reserved_word->flags;
+
+				if (curr_token.flags & TokenFlag_StaticValue)
 				{
-					invalid_token = invalid_token.substr(0, next_space);
-					next(next_space);
+					curr_token.literal = static_cast<uint32_t>(chunk.literals.size());
+					chunk.literals.push_back(Int { scanner::scan_int_literal(reserved_word->static_value).value });
 				}
-				else next(line.length());
-				
-				add_error("{}:{} -> Unrecognized token '{}'", filename, line_num, invalid_token);
 			}
+			else
+			{
+				curr_token.id = Token_Id;
+				curr_token.flags |= TokenFlag_Id;
+				curr_token.symbol = chunk.symbols->intern(token_found).id;
+			}
+
+			valid = true;
+		}
+		else if (auto token = scanner::match_static_token(str))
+		{
+			curr_token.id = token->id;
+			curr_token.flags = token->flags;
+			token_len = token->value.length();
+			valid = true;
 		}
 
-		++line_num;
-	}
+		if (valid)
+		{
+			if (!(curr_token.flags & TokenFlag_Id) && !curr_token.is_literal())
+				curr_token.length = static_cast<uint32_t>(token_len);
 
-	std::reverse(tokens.begin(), tokens.end());
+			curr_token.offset = static_cast<uint32_t>(it - text.data());
 
-	return true;
+			chunk.tokens.push_back(curr_token);
+
+			if (overflow)
+				chunk.error_tokens.push_back(curr_token);
+
+			it += token_len;
+		}
+		else
+		{
+			const auto invalid_token_end = std::find_if(it, end, is_separator);
+
+			auto& invalid_token = chunk.error_tokens.emplace_back();
+
+			invalid_token.offset = static_cast<uint32_t>(it - text.data());
+			invalid_token.length = static_cast<uint32_t>(invalid_token_end - it);
+
+			it = invalid_token_end;
+		}
+	}
 }
 
 void Lexer::print_list()
 {
 	PRINT_NL;
 
-	for (auto token : tokens)
-		PRINT_EX(Green, std::format("'{}' ", token->value), White, "(", Yellow, std::format("{}", STRIFY_TOKEN(token->id)), White, ")");
+	for (const auto& token : tokens)
+		PRINT_EX(Green, std::format("'{}' ", get_value(&token)), White, "(", Yellow, std::format("{}", STRIFY_TOKEN(token.id)), White, ")");
 }
 
 void Lexer::print_errors()
@@ -241,48 +499,117 @@ void Lexer::print_errors()
 		PRINT(Red, "{}", err);
 }
 
-Token* Lexer::push_and_pop()
+std::string_view Lexer::get_value(const Token* token) const
 {
-	check(!tokens.empty(), "EOF");
+	if (token->flags & TokenFlag_Id)
+		return g_symbols->get(token->get_symbol());
 
-	auto curr = current();
+	// literals keep their value instead of their length so their text
+	// is scanned again, this is only needed for printing
+
+	if (token->is_literal())
+	{
+		const auto str = text.substr(token->offset);
+
+		if (token->flags & TokenFlag_StaticValue)
+			return scanner::find_reserved_word(str.substr(0, scanner::scan_id(str)))->static_value;
+
+		return str.substr(0, scanner::scan_int_literal(str).length);
+	}
+
+	return text.substr(token->offset, token->length);
+}
+
+SourceLocation Lexer::get_location(const Token* token) const
+{
+	// the table of line starts is only built the first time a location is
+	// needed, with a single pass over the source (once, even if several
+	// parsers ask for it at the same time)
+
+	std::call_once(*line_starts_built, [&]()
+	{
+		line_starts.push_back(0);
+
+		scanner::find_line_starts(text.data(), text.data() + text.size(), 0, line_starts);
+	});
+
+	const auto line = std::upper_bound(line_starts.begin(), line_starts.end(), token->offset);
 
-	eaten_tokens.push_back(curr);
-	tokens.pop_back();
+	return
+	{
+		.line = static_cast<uint32_t>(line - line_starts.begin()),
+		.column = token->offset - *(line - 1) + 1,
+	};
+}
+
+std::string Lexer::get_location_str(const Token* token) const
+{
+	const auto location = get_location(token);
+
+	return std::format("{}:{}:{}", filename, location.line, location.column);
+}
+
+Token* TokenStream::advance()
+{
+	check(!eof(), "EOF");
+
+	return &tokens[index++];
+}
+
+bool TokenStream::skip_block()
+{
+	// moves past the '}' matching the current '{', the index is left as
+	// it was if the block is never closed
+
+	int depth = 0;
+
+	for (auto i = index; i < tokens.size(); ++i)
+	{
+		if (tokens[i].id == Token_BracketOpen)
+			++depth;
+		else if (tokens[i].id == Token_BracketClose && --depth == 0)
+		{
+			index = i + 1;
+
+			return true;
+		}
+	}
 
-	return curr;
+	return false;
 }
 
-Token* Lexer::eat_expect(TokenID expected_token)
+Token* TokenStream::eat_expect(TokenID expected_token)
 {
 	check(!eof(), "Expected a keyword, EOF found");
 
 	auto curr = current();
 
-	check(curr->id == expected_token, "Unexpected token '{}'", curr->value);
+	if (curr->id != expected_token)
+		global_error("{} -> Unexpected token '{}'", lexer->get_location_str(curr), lexer->get_value(curr));
 
-	return push_and_pop();
+	return advance();
 }
 
-Token* Lexer::eat_expect_keyword_declaration()
+Token* TokenStream::eat_expect_keyword_declaration()
 {
 	check(!eof(), "Expected a keyword, EOF found");
 
 	auto curr = current();
 
-	check(curr->flags & TokenFlag_KeywordType, "Unexpected token '{}'", curr->value);
+	if (!(curr->flags & TokenFlag_KeywordType))
+		global_error("{} -> Unexpected token '{}'", lexer->get_location_str(curr), lexer->get_value(curr));
 
-	return push_and_pop();
+	return advance();
 }
 
-Token* Lexer::eat()
+Token* TokenStream::eat()
 {
 	check(!eof(), "Expected a keyword, EOF found");
 
-	return push_and_pop();
+	return advance();
 }
 
-Token* Lexer::eat_if_current_is_int_literal()
+Token* TokenStream::eat_if_current_is_int_literal()
 {
 	switch (current_token_id())
 	{
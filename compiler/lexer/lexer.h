@@ -1,6 +1,10 @@
 #pragma once
 
-enum TokenID : int
+#include <io/mapped_file.h>
+
+#include "simd_scanner.h"
+
+enum TokenID : uint8_t
 {
 	Token_None = 0,
 	Token_Eof,
@@ -76,44 +80,61 @@ enum TokenID : int
 	Token_Continue,
 	Token_Return,
 	Token_Extern,
+
+	Token_Count,
 };
 
 #include <ir/types.h>
 #include <ast/types.h>
 
+/*
+* tokens are plain 12 bytes values stored contiguously in the lexer,
+* the text is not owned, identifiers reference their interned symbol,
+* literals their decoded value in the lexer and everything else its
+* length in the source buffer (see Lexer::get_value), lines and columns
+* are resolved from the offset when needed (see Lexer::get_location)
+*/
 struct Token
 {
 	static constexpr int LOWEST_PRECEDENCE = 16;
 
-	std::string value {};
+	uint32_t offset = 0;
+
+	union
+	{
+		uint32_t length = 0,
+				 symbol,
+				 literal;
+	};
 
 	TokenID id = Token_None;
 
-	uint64_t flags = TokenFlag_None;
+	uint8_t flags = TokenFlag_None;
+
+	int get_precedence() const;
 
-	int precedence = LOWEST_PRECEDENCE,
-		line = 0;
+	Symbol get_symbol() const				{ return ((flags & TokenFlag_Id) ? Symbol(symbol) : Symbol()); }
 
-	ast::Type to_ast_type(int indirection = 0)
+	bool is_literal() const					{ return (id >= Token_U8 && id <= Token_I64 && !(flags & TokenFlag_KeywordType)); }
+
+	ast::Type to_ast_type(int indirection = 0) const
 	{
-		ast::Type v {};
+		TypeID type = Type_None;
 
 		switch (id)
 		{
-		case Token_Void:	v.set_type(Type_Void); break;
-		case Token_U8:		v.set_type(Type_u8);   break;
-		case Token_I8:		v.set_type(Type_i8);   break;
-		case Token_U16:		v.set_type(Type_u16);  break;
-		case Token_I16:		v.set_type(Type_i16);  break;
-		case Token_U32:		v.set_type(Type_u32);  break;
-		case Token_I32:		v.set_type(Type_i32);  break;
-		case Token_U64:		v.set_type(Type_u64);  break;
-		case Token_I64:		v.set_type(Type_i64);  break;
+		case Token_Void:	type = Type_Void; break;
+		case Token_U8:		type = Type_u8;   break;
+		case Token_I8:		type = Type_i8;   break;
+		case Token_U16:		type = Type_u16;  break;
+		case Token_I16:		type = Type_i16;  break;
+		case Token_U32:		type = Type_u32;  break;
+		case Token_I32:		type = Type_i32;  break;
+		case Token_U64:		type = Type_u64;  break;
+		case Token_I64:		type = Type_i64;  break;
 		}
 
-		v.indirection = indirection;
-
-		return v;
+		return ast::Type(type, indirection);
 	}
 
 	static BinOpType to_bin_op_type(TokenID id)
@@ -175,57 +196,61 @@ struct Token
 
 		return UnaryOpType_None;
 	}
-
-	Token& operator = (const Token& token)
-	{
-		if (this != std::addressof(token))
-		{
-			value = token.value;
-			id = token.id;
-			flags = token.flags;
-			precedence = token.precedence;
-			line = token.line;
-		}
-
-		return *this;
-	}
 };
 
-inline std::unordered_map<std::string, TokenID> g_keywords =
+static_assert(sizeof(Token) == 12 && std::is_trivially_copyable_v<Token>);
+
+struct ReservedWord
 {
-	{ "for",		Token_For },
-	{ "while",		Token_While },
-	{ "do",			Token_Do },
-	{ "if",			Token_If },
-	{ "else",		Token_Else },
-	{ "break",		Token_Break },
-	{ "continue",	Token_Continue },
-	{ "return",		Token_Return },
-	{ "extern",		Token_Extern },		// not an statement but we put it here for now
+	std::string_view value {};
+
+	TokenID id = Token_None;
+
+	uint8_t flags = TokenFlag_None;
+
+	std::string_view static_value {};
 };
 
-inline std::unordered_map<std::string, std::tuple<TokenID, uint8_t, TokenFlag>> g_keywords_type =
+inline constexpr ReservedWord g_reserved_words[] =
 {
-	{ "void",	{ Token_Void,	 0,  TokenFlag_None } },
-	{ "bool",	{ Token_U8,		 8,  TokenFlag_Unsigned } },
-	{ "u8",		{ Token_U8,		 8,  TokenFlag_Unsigned } },
-	{ "u16",	{ Token_U16,	16,  TokenFlag_Unsigned } },
-	{ "u32",	{ Token_U32,	32,  TokenFlag_Unsigned } },
-	{ "u64",	{ Token_U64,	64,  TokenFlag_Unsigned } },
-	{ "i8",		{ Token_I8,		 8,  TokenFlag_None } },
-	{ "i16",	{ Token_I16,	16,  TokenFlag_None } },
-	{ "i32",	{ Token_I32,	32,  TokenFlag_None } },
-	{ "i64",	{ Token_I64,	64,  TokenFlag_None } },
-	{ "m128",	{ Token_M128,	128, TokenFlag_None } },
+	{ "for",		Token_For,		TokenFlag_Keyword },
+	{ "while",		Token_While,	TokenFlag_Keyword },
+	{ "do",			Token_Do,		TokenFlag_Keyword },
+	{ "if",			Token_If,		TokenFlag_Keyword },
+	{ "else",		Token_Else,		TokenFlag_Keyword },
+	{ "break",		Token_Break,	TokenFlag_Keyword },
+	{ "continue",	Token_Continue,	TokenFlag_Keyword },
+	{ "return",		Token_Return,	TokenFlag_Keyword },
+	{ "extern",		Token_Extern,	TokenFlag_Keyword },		// not an statement but we put it here for now
+
+	{ "void",		Token_Void,		TokenFlag_KeywordType },
+	{ "bool",		Token_U8,		TokenFlag_KeywordType | TokenFlag_Unsigned },
+	{ "u8",			Token_U8,		TokenFlag_KeywordType | TokenFlag_Unsigned },
+	{ "u16",		Token_U16,		TokenFlag_KeywordType | TokenFlag_Unsigned },
+	{ "u32",		Token_U32,		TokenFlag_KeywordType | TokenFlag_Unsigned },
+	{ "u64",		Token_U64,		TokenFlag_KeywordType | TokenFlag_Unsigned },
+	{ "i8",			Token_I8,		TokenFlag_KeywordType },
+	{ "i16",		Token_I16,		TokenFlag_KeywordType },
+	{ "i32",		Token_I32,		TokenFlag_KeywordType },
+	{ "i64",		Token_I64,		TokenFlag_KeywordType },
+	{ "m128",		Token_M128,		TokenFlag_KeywordType },
+
+	{ "true",		Token_U8,		TokenFlag_Unsigned | TokenFlag_StaticValue, "1" },
+	{ "false",		Token_U8,		TokenFlag_Unsigned | TokenFlag_StaticValue, "0" },
 };
 
-inline std::unordered_map<std::string, TokenID> g_static_values =
+struct StaticToken
 {
-	{ "true",	Token_U8 },
-	{ "false",	Token_U8 },
+	std::string_view value {};
+
+	TokenID id = Token_None;
+
+	uint8_t flags = TokenFlag_None;
+
+	int precedence = Token::LOWEST_PRECEDENCE;
 };
 
-inline Token g_static_tokens[] =
+inline constexpr StaticToken g_static_tokens[] =
 {
 	{.value = ">>=", .id = Token_ShrAssign, .flags = TokenFlag_Op | TokenFlag_Assignation, .precedence = 14 },
 	{.value = "<<=", .id = Token_ShlAssign, .flags = TokenFlag_Op | TokenFlag_Assignation, .precedence = 14 },
@@ -275,27 +300,460 @@ inline Token g_static_tokens[] =
 	{ .value = "<", .id = Token_Lt,			.flags = TokenFlag_Op,							.precedence = 6 },
 };
 
-namespace regex
+inline constexpr auto g_token_precedences = []()
 {
-	static inline std::regex SINGLE_COMMENT("\\/{2}.*$"),
-							 WORD("\\b[a-zA-Z_][a-zA-Z0-9_]*\\b"),
-							 INT_LITERAL("([0-9]{1,20})((u|i)(8|16|32|64))?");
+	std::array<int, Token_Count> precedences {};
+
+	precedences.fill(Token::LOWEST_PRECEDENCE);
+
+	for (const auto& token : g_static_tokens)
+		precedences[token.id] = token.precedence;
+
+	return precedences;
+}();
+
+inline int Token::get_precedence() const
+{
+	return g_token_precedences[id];
 }
 
+namespace scanner
+{
+	enum CharClass : uint8_t
+	{
+		Char_None		= 0,
+		Char_Space		= (1 << 0),
+		Char_Digit		= (1 << 1),
+		Char_IdBegin	= (1 << 2),
+		Char_IdContinue	= (1 << 3),
+	};
+
+	inline constexpr auto CHAR_CLASSES = []()
+	{
+		std::array<uint8_t, 256> classes {};
+
+		classes[' '] = classes['\t'] = Char_Space;
+
+		for (int c = '0'; c <= '9'; ++c) classes[c] = Char_Digit | Char_IdContinue;
+		for (int c = 'a'; c <= 'z'; ++c) classes[c] = Char_IdBegin | Char_IdContinue;
+		for (int c = 'A'; c <= 'Z'; ++c) classes[c] = Char_IdBegin | Char_IdContinue;
+
+		classes['_'] = Char_IdBegin | Char_IdContinue;
+
+		return classes;
+	}();
+
+	inline bool is(char c, CharClass v)		{ return (CHAR_CLASSES[static_cast<uint8_t>(c)] & v); }
+	inline bool is_space(char c)			{ return is(c, Char_Space); }
+	inline bool is_digit(char c)			{ return is(c, Char_Digit); }
+	inline bool is_id_begin(char c)			{ return is(c, Char_IdBegin); }
+	inline bool is_id_continue(char c)		{ return is(c, Char_IdContinue); }
+
+	struct IntLiteral
+	{
+		uint64_t value = 0;
+
+		size_t length = 0,
+			   digits = 0;
+
+		int size = 0;
+
+		bool is_unsigned = false,
+			 overflow = false;
+	};
+
+	/*
+	* scans ([0-9]{1,20})((u|i)(8|16|32|64))? anchored at the beginning
+	* of 'str', the suffix is only consumed when it's one of the valid sizes,
+	* the value is decoded on the way and checked against the suffix type,
+	* literals without a suffix take the smallest of i32, i64 and u64 that
+	* holds them and only overflow past 64 bits
+	*/
+	inline IntLiteral scan_int_literal(std::string_view str)
+	{
+		static constexpr size_t MAX_DIGITS = 20;
+
+		// 19 digits always fit in 64 bits, only the 20th one can overflow
+
+		static constexpr uint64_t MAX_SAFE_VALUE = std::numeric_limits<uint64_t>::max() / 10,
+								  MAX_SAFE_DIGIT = std::numeric_limits<uint64_t>::max() % 10;
+
+		IntLiteral res {};
+
+		const auto len = std::min(str.length(), MAX_DIGITS);
+
+		for (; res.digits < len && is_digit(str[res.digits]); ++res.digits)
+		{
+			const auto digit = static_cast<uint64_t>(str[res.digits] - '0');
+
+			if (res.digits == MAX_DIGITS - 1)
+				res.overflow = (res.value > MAX_SAFE_VALUE || (res.value == MAX_SAFE_VALUE && digit > MAX_SAFE_DIGIT));
+
+			res.value = res.value * 10 + digit;
+		}
+
+		res.length = res.digits;
+
+		auto check_overflow = [&]()
+		{
+			if (res.size == 0)
+			{
+				if (res.value <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max()) && !res.overflow)	res.size = 32;
+				else if (res.value <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) && !res.overflow)	res.size = 64;
+				else
+				{
+					res.size = 64;
+					res.is_unsigned = true;
+				}
+
+				return res;
+			}
+
+			const auto max_value = (res.is_unsigned ? (std::numeric_limits<uint64_t>::max() >> (64 - res.size))
+													: (std::numeric_limits<uint64_t>::max() >> (65 - res.size)));
+
+			res.overflow |= (res.value > max_value);
+
+			return res;
+		};
+
+		if (res.digits == 0 || res.digits >= str.length())
+			return check_overflow();
+
+		const auto sign = str[res.digits];
+
+		if (sign != 'u' && sign != 'i')
+			return check_overflow();
+
+		const auto suffix = str.substr(res.digits + 1);
+
+		if (suffix.starts_with("8"))		res.size = 8;
+		else if (suffix.starts_with("16"))	res.size = 16;
+		else if (suffix.starts_with("32"))	res.size = 32;
+		else if (suffix.starts_with("64"))	res.size = 64;
+		else								return check_overflow();
+
+		res.is_unsigned = (sign == 'u');
+		res.length += (res.size == 8 ? 2 : 3);
+
+		return check_overflow();
+	}
+
+	inline size_t scan_id(std::string_view str)
+	{
+		if (str.empty() || !is_id_begin(str[0]))
+			return 0;
+
+		return (skip_id_continue(str.data() + 1, str.data() + str.length()) - str.data());
+	}
+
+	/*
+	* perfect hash of every reserved word using its first and last characters
+	* and its length, the table is built at compile time so classifying an
+	* identifier is a single probe and a string compare
+	*/
+	inline constexpr size_t RESERVED_WORDS_TABLE_SIZE = 64;
+
+	inline constexpr size_t hash_reserved_word(std::string_view str)
+	{
+		return (static_cast<uint8_t>(str.front()) + static_cast<uint8_t>(str.back()) + str.length() * 11) & (RESERVED_WORDS_TABLE_SIZE - 1);
+	}
+
+	inline constexpr auto RESERVED_WORDS_TABLE = []()
+	{
+		std::array<int8_t, RESERVED_WORDS_TABLE_SIZE> table {};
+
+		table.fill(-1);
+
+		for (int i = 0; i < static_cast<int>(std::size(g_reserved_words)); ++i)
+			table[hash_reserved_word(g_reserved_words[i].value)] = static_cast<int8_t>(i);
+
+		return table;
+	}();
+
+	static_assert(std::ranges::count_if(RESERVED_WORDS_TABLE, [](int8_t v) { return v != -1; }) == std::size(g_reserved_words),
+		"Reserved words collide in the perfect hash, tweak hash_reserved_word");
+
+	inline const ReservedWord* find_reserved_word(std::string_view str)
+	{
+		if (str.empty())
+			return nullptr;
+
+		const auto index = RESERVED_WORDS_TABLE[hash_reserved_word(str)];
+		if (index == -1)
+			return nullptr;
+
+		const auto& word = g_reserved_words[index];
+
+		return (word.value == str ? &word : nullptr);
+	}
+
+	/*
+	* trie over every static token built at compile time from g_static_tokens,
+	* matching walks it one character at a time and keeps the last token found
+	* so the longest operator always wins no matter the order of the table
+	*/
+	struct StaticTokenNode
+	{
+		std::array<uint8_t, 128> next {};
+
+		int8_t token = -1;
+	};
+
+	inline constexpr size_t STATIC_TOKENS_TRIE_SIZE = []()
+	{
+		size_t size = 1;
+
+		for (const auto& token : g_static_tokens)
+			size += token.value.length();
+
+		return size;
+	}();
+
+	// node ids are stored as uint8_t and token indices as int8_t
+
+	static_assert(STATIC_TOKENS_TRIE_SIZE <= 256 && std::size(g_static_tokens) <= 127,
+		"Static tokens don't fit in the trie node types, widen StaticTokenNode");
+
+	inline constexpr auto STATIC_TOKENS_TRIE = []()
+	{
+		std::array<StaticTokenNode, STATIC_TOKENS_TRIE_SIZE> trie {};
+
+		size_t nodes_count = 1;
+
+		for (int i = 0; i < static_cast<int>(std::size(g_static_tokens)); ++i)
+		{
+			size_t node = 0;
+
+			for (auto c : g_static_tokens[i].value)
+			{
+				auto& next = trie[node].next[static_cast<uint8_t>(c)];
+
+				if (next == 0)
+					next = static_cast<uint8_t>(nodes_count++);
+
+				node = next;
+			}
+
+			trie[node].token = static_cast<int8_t>(i);
+		}
+
+		return trie;
+	}();
+
+	inline constexpr const StaticToken* match_static_token(std::string_view str)
+	{
+		const StaticToken* found = nullptr;
+
+		size_t node = 0;
+
+		for (auto c : str)
+		{
+			const auto uc = static_cast<uint8_t>(c);
+
+			if (uc >= 128 || (node = STATIC_TOKENS_TRIE[node].next[uc]) == 0)
+				break;
+
+			if (const auto token = STATIC_TOKENS_TRIE[node].token; token != -1)
+				found = &g_static_tokens[token];
+		}
+
+		return found;
+	}
+
+	/*
+	* the trie must tokenize the same as the first match scan over
+	* g_static_tokens it replaced, for every static token, every pair of
+	* adjacent static tokens and operators next to identifiers and literals
+	*/
+	inline constexpr const StaticToken* match_static_token_linear(std::string_view str)
+	{
+		for (const auto& token : g_static_tokens)
+			if (str.starts_with(token.value))
+				return &token;
+
+		return nullptr;
+	}
+
+	// splits 'str' into identifier/literal runs and static tokens and
+	// checks the ids of the static tokens against 'ids'
+
+	inline constexpr bool check_static_tokens(std::string_view str, std::initializer_list<TokenID> ids)
+	{
+		auto id = ids.begin();
+
+		while (!str.empty())
+		{
+			if (CHAR_CLASSES[static_cast<uint8_t>(str[0])] & Char_IdContinue)
+			{
+				while (!str.empty() && (CHAR_CLASSES[static_cast<uint8_t>(str[0])] & Char_IdContinue))
+					str.remove_prefix(1);
+
+				continue;
+			}
+
+			const auto token = match_static_token(str);
+
+			if (!token || token != match_static_token_linear(str) || id == ids.end() || token->id != *id++)
+				return false;
+
+			str.remove_prefix(token->value.length());
+		}
+
+		return id == ids.end();
+	}
+
+	static_assert([]()
+	{
+		for (const auto& token : g_static_tokens)
+		{
+			for (auto c : token.value)
+				if (static_cast<uint8_t>(c) >= 128)
+					return false;
+
+			if (match_static_token(token.value) != match_static_token_linear(token.value))
+				return false;
+
+			for (const auto& next_token : g_static_tokens)
+			{
+				char buffer[16] {};
+
+				size_t len = 0;
+
+				for (auto c : token.value)		buffer[len++] = c;
+				for (auto c : next_token.value)	buffer[len++] = c;
+
+				const auto str = std::string_view(buffer, len);
+
+				if (match_static_token(str) != match_static_token_linear(str))
+					return false;
+			}
+		}
+
+		return true;
+	}(), "Static tokens trie doesn't match the static tokens scan");
+
+	static_assert(check_static_tokens("a+=b",			{ Token_AddAssign }) &&
+				  check_static_tokens("x--1",			{ Token_Dec }) &&
+				  check_static_tokens("1<<2",			{ Token_Shl }) &&
+				  check_static_tokens("a>>=1u8",		{ Token_ShrAssign }) &&
+				  check_static_tokens("x=-y",			{ Token_Assign, Token_Sub }) &&
+				  check_static_tokens("a<=b&&!c",		{ Token_Lte, Token_LogicalAnd, Token_LogicalNot }) &&
+				  check_static_tokens("f(a,b[1])!=0",	{ Token_ParenOpen, Token_Comma, Token_BraceOpen, Token_BraceClose, Token_ParenClose, Token_NotEqual }) &&
+				  check_static_tokens("i+++j",			{ Token_Inc, Token_Add }),
+		"Static tokens next to identifiers and literals don't tokenize as expected");
+}
+
+/*
+* byte range that differs between two versions of a source, [begin, old_end)
+* in the old one was replaced by [begin, new_end) in the new one
+*/
+struct SourceEdit
+{
+	uint32_t begin = 0,
+			 old_end = 0,
+			 new_end = 0;
+
+	int64_t get_delta() const		{ return static_cast<int64_t>(new_end) - old_end; }
+};
+
+struct SourceLocation
+{
+	uint32_t line = 0,
+			 column = 0;
+};
+
 class Lexer
 {
 private:
 
-	std::vector<Token*> tokens,
-						eaten_tokens;
+	static constexpr size_t MIN_CHUNK_SIZE = 0x100000;
+
+	/*
+	* slice of the source lexed on its own, symbols and literals are local
+	* to the chunk until the chunks are stitched together
+	*/
+	struct Chunk
+	{
+		const char* begin = nullptr,
+				  * end = nullptr;
+
+		SymbolTable* symbols = nullptr;
+
+		SymbolTable local_symbols;
+
+		std::vector<Token> tokens,
+						   error_tokens;
+
+		std::vector<Int> literals;
+
+		std::vector<uint32_t> symbols_remap;
+
+		size_t first_token = 0,
+			   first_literal = 0;
+
+		bool open_comment = false;
+	};
+
+	std::vector<Token> tokens;
+
+	std::vector<Int> literals;
 
 	std::vector<std::string> errors;
 
+	MappedFile source;
+
+	// sources updated by 'relex' are owned since the file they came from
+	// may be rewritten at any time, 'text' is whatever version is current
+
+	std::string edited_source;
+
+	std::string_view text;
+
+	std::string filename;
+
+	/*
+	* what the last 'relex' replaced, the window tokens and the previous
+	* source, kept until the next edit so the caller can go back to the
+	* previous version when it can't use the new tokens (see Lexer::undo_relex)
+	*/
+	struct RelexUndo
+	{
+		std::vector<Token> tokens;
+
+		std::string source;
+
+		std::string_view text;
+
+		size_t first_token = 0,
+			   new_tokens_count = 0,
+			   literals_count = 0;
+
+		int64_t delta = 0;
+
+		bool edited = false,
+			 valid = false;
+	};
+
+	RelexUndo last_relex;
+
+	mutable std::vector<uint32_t> line_starts;
+
+	mutable std::unique_ptr<std::once_flag> line_starts_built = std::make_unique<std::once_flag>();
+
+	std::vector<const char*> split_source(size_t count) const;
+
+	void lex_chunk(Chunk& chunk) const;
+
 public:
 
-	~Lexer();
+	bool run(const std::string& filename, size_t threads = 1);
+
+	SourceEdit diff(std::string_view new_source) const;
 
-	bool run(const std::string& filename);
+	std::optional<size_t> relex(std::string new_source, const SourceEdit& edit, uint32_t begin, uint32_t end, size_t first_token, size_t last_token);
+
+	void undo_relex();
 
 	void print_list();
 	void print_errors();
@@ -305,29 +763,23 @@ public:
 	{
 		errors.push_back(std::format(format, args...));
 	}
-	
-	bool is_token_operator()							{ return (current()->flags & TokenFlag_Op); }
-	bool is_token_keyword()								{ return (current()->flags & TokenFlag_Keyword); }
-	bool is_token_keyword_type()						{ return (current()->flags & TokenFlag_KeywordType); }
-	bool is_current(TokenID id)							{ return (current_token_id() == id); }
-	bool is_next(TokenID id)							{ return (next_token() == id); }
-	bool is(Token* token, TokenID id)					{ return (token->id == id); }
-	bool eof()											{ return tokens.empty(); }
 
-	Token* push_and_pop();
-	Token* eat_expect(TokenID expected_token);
-	Token* eat_expect_keyword_declaration();
-	Token* eat();
-	Token* eat_if_current_is_int_literal();
-	Token* eat_if_current_is_type()						{ return (is_token_keyword_type() ? eat() : nullptr); }
-	Token* eat_if_current_is_keyword()					{ return (is_token_keyword() ? eat() : nullptr); }
-	Token* eat_if_current_is(TokenID id)				{ return (is_current(id) ? eat() : nullptr); }
-	Token* current() const								{ return (tokens.empty() ? nullptr : tokens.back()); }
+	std::string_view get_value(const Token* token) const;
+
+	uint32_t get_end(const Token* token) const			{ return token->offset + static_cast<uint32_t>(get_value(token).size()); }
+
+	Int get_literal(const Token* token) const			{ return literals[token->literal]; }
 
-	TokenID current_token_id() const					{ return (tokens.empty() ? Token_Eof : tokens.back()->id); }
-	TokenID next_token() const							{ return (tokens.size() < 2 ? Token_Eof : (*(tokens.rbegin() + 1))->id); }
+	SourceLocation get_location(const Token* token) const;
+
+	std::string get_location_str(const Token* token) const;
 		
+	bool has_errors() const								{ return !errors.empty(); }
+
+	std::span<Token> get_tokens()						{ return tokens; }
+
 	const size_t get_tokens_count() const				{ return tokens.size(); }
+	const size_t get_source_size() const				{ return text.size(); }
 
 	// static methods
 
@@ -411,4 +863,51 @@ public:
 	}
 };
 
+/*
+* read cursor over the tokens of a lexer, every parser owns one so
+* several of them can walk the same token stream at once, the tokens are
+* never modified once the lexer is done
+*/
+class TokenStream
+{
+private:
+
+	const Lexer* lexer = nullptr;
+
+	std::span<Token> tokens;
+
+	size_t index = 0;
+
+public:
+
+	TokenStream() {}
+	TokenStream(Lexer* lexer) : lexer(lexer), tokens(lexer->get_tokens()) {}
+
+	bool is_token_operator()							{ return (current()->flags & TokenFlag_Op); }
+	bool is_token_keyword()								{ return (current()->flags & TokenFlag_Keyword); }
+	bool is_token_keyword_type()						{ return (current()->flags & TokenFlag_KeywordType); }
+	bool is_current(TokenID id)							{ return (current_token_id() == id); }
+	bool is_next(TokenID id)							{ return (next_token() == id); }
+	bool is(Token* token, TokenID id)					{ return (token->id == id); }
+	bool eof() const									{ return (index >= tokens.size()); }
+
+	Token* advance();
+	bool skip_block();
+	Token* eat_expect(TokenID expected_token);
+	Token* eat_expect_keyword_declaration();
+	Token* eat();
+	Token* eat_if_current_is_int_literal();
+	Token* eat_if_current_is_type()						{ return (is_token_keyword_type() ? eat() : nullptr); }
+	Token* eat_if_current_is_keyword()					{ return (is_token_keyword() ? eat() : nullptr); }
+	Token* eat_if_current_is(TokenID id)				{ return (is_current(id) ? eat() : nullptr); }
+	Token* current()									{ return (eof() ? nullptr : &tokens[index]); }
+
+	TokenID current_token_id() const					{ return (eof() ? Token_Eof : tokens[index].id); }
+	TokenID next_token() const							{ return (index + 1 >= tokens.size() ? Token_Eof : tokens[index + 1].id); }
+
+	const size_t get_index() const						{ return index; }
+
+	void set_index(size_t v)							{ index = v; }
+};
+
 inline std::unique_ptr<Lexer> g_lexer;
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <defs.h>
+
+#include "simd_scanner.h"
+
+#include <lexer/lexer.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_SCANNER_X86
+#endif
+
+#ifdef SIMD_SCANNER_X86
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace scanner
+{
+	namespace scalar
+	{
+		const char* skip_blanks(const char* it, const char* end)
+		{
+			while (it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n'))
+				++it;
+
+			return it;
+		}
+
+		const char* skip_id_continue(const char* it, const char* end)
+		{
+			while (it != end && is_id_continue(*it))
+				++it;
+
+			return it;
+		}
+
+		const char* find_newline(const char* it, const char* end)
+		{
+			return std::find(it, end, '\n');
+		}
+
+		const char* find_comment_end(const char* it, const char* end)
+		{
+			for (; it != end; ++it)
+				if (*it == '*' && it + 1 != end && *(it + 1) == '/')
+					return it;
+
+			return end;
+		}
+
+		void find_line_starts(const char* it, const char* end, uint32_t offset, std::vector<uint32_t>& line_starts)
+		{
+			for (uint32_t i = 0; it + i != end; ++i)
+				if (it[i] == '\n')
+					line_starts.push_back(offset + i + 1);
+		}
+	}
+
+#ifdef SIMD_SCANNER_X86
+	namespace sse2
+	{
+		static constexpr ptrdiff_t WIDTH = 16;
+
+		__m128i load(const char* it)	{ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)); }
+		__m128i eq(__m128i v, char c)	{ return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+		uint32_t mask(__m128i v)		{ return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+
+		// unsigned 'lo <= v <= hi' per byte
+
+		__m128i in_range(__m128i v, char lo, char hi)
+		{
+			const auto d = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+
+			return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(static_cast<char>(hi - lo))), d);
+		}
+
+		const char* skip_blanks(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+			{
+				const auto v = load(it);
+
+				const auto blanks = _mm_or_si128(_mm_or_si128(eq(v, ' '), eq(v, '\t')), _mm_or_si128(eq(v, '\r'), eq(v, '\n')));
+
+				if (const auto m = ~mask(blanks) & 0xffff)
+					return it + std::countr_zero(m);
+			}
+
+			return scalar::skip_blanks(it, end);
+		}
+
+		const char* skip_id_continue(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+			{
+				const auto v = load(it);
+
+				const auto alpha = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'),
+						   digit = in_range(v, '0', '9');
+
+				if (const auto m = ~mask(_mm_or_si128(_mm_or_si128(alpha, digit), eq(v, '_'))) & 0xffff)
+					return it + std::countr_zero(m);
+			}
+
+			return scalar::skip_id_continue(it, end);
+		}
+
+		const char* find_newline(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+				if (const auto m = mask(eq(load(it), '\n')))
+					return it + std::countr_zero(m);
+
+			return scalar::find_newline(it, end);
+		}
+
+		const char* find_comment_end(const char* it, const char* end)
+		{
+			for (; end - it > WIDTH; it += WIDTH)
+				if (const auto m = mask(_mm_and_si128(eq(load(it), '*'), eq(load(it + 1), '/'))))
+					return it + std::countr_zero(m);
+
+			return scalar::find_comment_end(it, end);
+		}
+
+		void find_line_starts(const char* it, const char* end, uint32_t offset, std::vector<uint32_t>& line_starts)
+		{
+			for (; end - it >= WIDTH; it += WIDTH, offset += WIDTH)
+				for (auto m = mask(eq(load(it), '\n')); m; m &= m - 1)
+					line_starts.push_back(offset + std::countr_zero(m) + 1);
+
+			scalar::find_line_starts(it, end, offset, line_starts);
+		}
+	}
+
+	namespace avx2
+	{
+		static constexpr ptrdiff_t WIDTH = 32;
+
+		TARGET_AVX2 __m256i load(const char* it)	{ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)); }
+		TARGET_AVX2 __m256i eq(__m256i v, char c)	{ return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); }
+		TARGET_AVX2 uint32_t mask(__m256i v)		{ return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+
+		TARGET_AVX2 __m256i in_range(__m256i v, char lo, char hi)
+		{
+			const auto d = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+
+			return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(static_cast<char>(hi - lo))), d);
+		}
+
+		TARGET_AVX2 const char* skip_blanks(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+			{
+				const auto v = load(it);
+
+				const auto blanks = _mm256_or_si256(_mm256_or_si256(eq(v, ' '), eq(v, '\t')), _mm256_or_si256(eq(v, '\r'), eq(v, '\n')));
+
+				if (const auto m = ~mask(blanks))
+					return it + std::countr_zero(m);
+			}
+
+			return sse2::skip_blanks(it, end);
+		}
+
+		TARGET_AVX2 const char* skip_id_continue(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+			{
+				const auto v = load(it);
+
+				const auto alpha = in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'),
+						   digit = in_range(v, '0', '9');
+
+				if (const auto m = ~mask(_mm256_or_si256(_mm256_or_si256(alpha, digit), eq(v, '_'))))
+					return it + std::countr_zero(m);
+			}
+
+			return sse2::skip_id_continue(it, end);
+		}
+
+		TARGET_AVX2 const char* find_newline(const char* it, const char* end)
+		{
+			for (; end - it >= WIDTH; it += WIDTH)
+				if (const auto m = mask(eq(load(it), '\n')))
+					return it + std::countr_zero(m);
+
+			return sse2::find_newline(it, end);
+		}
+
+		TARGET_AVX2 const char* find_comment_end(const char* it, const char* end)
+		{
+			for (; end - it > WIDTH; it += WIDTH)
+				if (const auto m = mask(_mm256_and_si256(eq(load(it), '*'), eq(load(it + 1), '/'))))
+					return it + std::countr_zero(m);
+
+			return sse2::find_comment_end(it, end);
+		}
+
+		TARGET_AVX2 void find_line_starts(const char* it, const char* end, uint32_t offset, std::vector<uint32_t>& line_starts)
+		{
+			for (; end - it >= WIDTH; it += WIDTH, offset += WIDTH)
+				for (auto m = mask(eq(load(it), '\n')); m; m &= m - 1)
+					line_starts.push_back(offset + std::countr_zero(m) + 1);
+
+			sse2::find_line_starts(it, end, offset, line_starts);
+		}
+	}
+
+	bool cpu_has_sse2()
+	{
+#ifdef _MSC_VER
+		int info[4] {};
+
+		__cpuid(info, 1);
+
+		return (info[3] & (1 << 26));
+#else
+		__builtin_cpu_init();
+
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+
+	bool cpu_has_avx2()
+	{
+#ifdef _MSC_VER
+		int info[4] {};
+
+		__cpuid(info, 0);
+
+		if (info[0] < 7)
+			return false;
+
+		// the OS must also save the ymm registers on context switches
+
+		__cpuid(info, 1);
+
+		const bool osxsave = (info[2] & (1 << 27)),
+				   avx = (info[2] & (1 << 28));
+
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+
+		return (info[1] & (1 << 5));
+#else
+		__builtin_cpu_init();
+
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	RunScanners select_run_scanners()
+	{
+#ifdef SIMD_SCANNER_X86
+		if (cpu_has_avx2())
+			return { avx2::skip_blanks, avx2::skip_id_continue, avx2::find_newline, avx2::find_comment_end, avx2::find_line_starts };
+
+		if (cpu_has_sse2())
+			return { sse2::skip_blanks, sse2::skip_id_continue, sse2::find_newline, sse2::find_comment_end, sse2::find_line_starts };
+#endif
+
+		return { scalar::skip_blanks, scalar::skip_id_continue, scalar::find_newline, scalar::find_comment_end, scalar::find_line_starts };
+	}
+}
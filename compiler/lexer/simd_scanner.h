@@ -0,0 +1,47 @@
+#pragma once
+
+namespace scanner
+{
+	/*
+	* scanners for the byte runs that dominate the sources (indentation,
+	* comment bodies and identifiers), each one returns the first byte in
+	* [it, end) that doesn't belong to the run or 'end', plus the newlines
+	* search used to build the lines table
+	*/
+	struct RunScanners
+	{
+		const char* (*skip_blanks)(const char* it, const char* end) = nullptr;
+		const char* (*skip_id_continue)(const char* it, const char* end) = nullptr;
+		const char* (*find_newline)(const char* it, const char* end) = nullptr;
+		const char* (*find_comment_end)(const char* it, const char* end) = nullptr;
+		void (*find_line_starts)(const char* it, const char* end, uint32_t offset, std::vector<uint32_t>& line_starts) = nullptr;
+	};
+
+	/*
+	* AVX2, SSE2 or scalar implementations, picked once at startup using
+	* CPUID
+	*/
+	RunScanners select_run_scanners();
+
+	inline const RunScanners g_run_scanners = select_run_scanners();
+
+	// skips spaces, tabs, carriage returns and newlines
+
+	inline const char* skip_blanks(const char* it, const char* end)			{ return g_run_scanners.skip_blanks(it, end); }
+
+	// skips [A-Za-z0-9_]
+
+	inline const char* skip_id_continue(const char* it, const char* end)	{ return g_run_scanners.skip_id_continue(it, end); }
+	inline const char* find_newline(const char* it, const char* end)		{ return g_run_scanners.find_newline(it, end); }
+
+	// returns the position of the '*' of the first "*/" found
+
+	inline const char* find_comment_end(const char* it, const char* end)	{ return g_run_scanners.find_comment_end(it, end); }
+
+	// appends the offset of the byte after every '\n' in [it, end), 'offset' being the offset of 'it'
+
+	inline void find_line_starts(const char* it, const char* end, uint32_t offset, std::vector<uint32_t>& line_starts)
+	{
+		g_run_scanners.find_line_starts(it, end, offset, line_starts);
+	}
+}
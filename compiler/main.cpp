@@ -3,6 +3,8 @@
 #include <intrin/intrin.h>
 #include <lexer/lexer.h>
 #include <syntax/syntax.h>
+#include <ast/flat.h>
+#include <ast/cache.h>
 #include <semantic/semantic.h>
 #include <ir/ir.h>
 
@@ -31,47 +33,656 @@ void test_ir() {
 	delete prototype;
 }
 
-int main()
+/*
+* a fresh lexer, parser and semantic over a generated source written to
+* bench_<name>.ankh, the globals are recreated again once the bench is
+* done with them
+*/
+struct BenchPipeline
 {
-	setup_console();
+	std::string filename;
 
-	g_intrin = std::make_unique<Intrinsic>();
-	g_lexer = std::make_unique<Lexer>();
-	g_syntax = std::make_unique<Syntax>();
-	g_semantic = std::make_unique<Semantic>();
-	//g_ir = std::make_unique<IR>();
+	BenchPipeline(const std::string& name, const std::string& source) : filename(std::format("bench_{}.ankh", name))
+	{
+		std::ofstream(filename) << source;
+
+		reset();
+	}
+
+	~BenchPipeline() { reset(); }
+
+	void reset()
+	{
+		g_semantic = std::make_unique<Semantic>();
+		g_syntax = std::make_unique<Syntax>();
+		g_lexer = std::make_unique<Lexer>();
+	}
+};
+
+void bench_syntax(const std::string& name, const std::string& source)
+{
+	BenchPipeline pipeline(name, source);
+
+	PROFILE(std::format("Syntax Time ({})", name));
+	g_lexer->run(pipeline.filename);
+	g_syntax->run();
+}
+
+void bench_lexer()
+{
+	// ~256MB of functions with comments, suffixed literals and operators
+	// next to identifiers, lexed serially once and then with 2 to 16
+	// threads, every parallel run must stitch the exact same tokens and
+	// literals the serial one produced
+
+	static constexpr size_t SOURCE_SIZE = 256ull * 1024 * 1024;
+
+	std::string source;
+
+	for (int i = 0; source.size() < SOURCE_SIZE; ++i)
+		source += std::format("/* fn{0}\n*/ i32 fn{0}(i32 a, u8 b) {{ i64 c = a<<{1}u8; c+=a--*{0}u32; b=-b; // {0}\n if (c>={0}&&!b) {{ return c%{1}i8; }} return a>>=b; }}\n", i, i % 64);
+
+	BenchPipeline pipeline("lexer", source);
+
+	source = {};
+
+	Lexer serial;
+
+	{
+		PROFILE("Lexer Time (1 threads)");
+		serial.run(pipeline.filename, 1);
+		PROFILE_BYTES(serial.get_source_size());
+	}
+
+	const auto serial_tokens = serial.get_tokens();
+
+	for (size_t threads : { 2, 4, 8, 16 })
+	{
+		Lexer lexer;
+
+		{
+			PROFILE(std::format("Lexer Time ({} threads)", threads));
+			lexer.run(pipeline.filename, threads);
+			PROFILE_BYTES(lexer.get_source_size());
+		}
+
+		const auto tokens = lexer.get_tokens();
+
+		check(tokens.size() == serial_tokens.size() && lexer.has_errors() == serial.has_errors(), "Parallel lexer produced {} tokens instead of {} ({} threads)", tokens.size(), serial_tokens.size(), threads);
+
+		for (size_t i = 0; i < tokens.size(); ++i)
+		{
+			const auto& token = tokens[i],
+					  & serial_token = serial_tokens[i];
+
+			const bool same = token.offset == serial_token.offset &&
+							  token.length == serial_token.length &&
+							  token.id == serial_token.id &&
+							  token.flags == serial_token.flags &&
+							  (!token.is_literal() || lexer.get_literal(&token) == serial.get_literal(&serial_token));
+
+			check(same, "Parallel lexer token {} '{}' doesn't match the serial one '{}' ({} threads)", i, lexer.get_value(&token), serial.get_value(&serial_token), threads);
+		}
+	}
+}
+
+void bench_identifiers()
+{
+	// 20k functions with long parameter and local names read over and
+	// over, each one calls the previous one so semantic time is mostly
+	// identifier and prototype lookups
+
+	static constexpr int FUNCTIONS_COUNT = 20000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+	{
+		const auto first = std::format("first_input_parameter_{}", i),
+				   second = std::format("second_input_parameter_{}", i);
+
+		source += std::format("i32 compute_accumulated_value_{}(i32 {}, i32 {}) {{ ", i, first, second);
+		source += std::format("i32 accumulated_result_value = {} * {}; ", first, second);
+		source += std::format("i32 temporary_intermediate_value = accumulated_result_value + {}; ", first);
+		source += "i32 loop_iteration_counter_value = 0; ";
+		source += std::format("while (loop_iteration_counter_value < {}) {{ ", second);
+		source += "accumulated_result_value = accumulated_result_value + temporary_intermediate_value * loop_iteration_counter_value; ";
+		source += std::format("temporary_intermediate_value = temporary_intermediate_value - {} + {}; ", first, second);
+		source += "loop_iteration_counter_value = loop_iteration_counter_value + 1; } ";
+		source += "if (accumulated_result_value > temporary_intermediate_value) { accumulated_result_value = temporary_intermediate_value - accumulated_result_value; } ";
+		source += (i > 0 ? std::format("return compute_accumulated_value_{}(accumulated_result_value, temporary_intermediate_value); }}\n", i - 1)
+						 : "return accumulated_result_value + temporary_intermediate_value; }\n");
+	}
+
+	BenchPipeline pipeline("identifiers", source);
+
+	g_lexer->run(pipeline.filename);
+	g_syntax->run();
+
+	PROFILE("Semantic Time (identifiers)");
+	g_semantic->run();
+}
+
+void bench_expressions()
+{
+	// sums and assignment chains of 10k terms, the parser time must
+	// grow linearly with the terms count
+
+	for (int terms : { 1000, 10000 })
+	{
+		std::string sum = "i32 main() { i32 x = 0; x = 1",
+					mixed = "i32 main() { i32 x = 0; x = 1",
+					assign = "i32 main() { i32 x = 0; x";
+
+		for (int i = 0; i < terms; ++i)
+		{
+			sum += " + x";
+			mixed += (i % 2 ? " * x" : " - x << 1");
+			assign += " = x";
+		}
+
+		bench_syntax(std::format("sum_{}", terms), sum + "; return x; }");
+		bench_syntax(std::format("mixed_{}", terms), mixed + "; return x; }");
+		bench_syntax(std::format("assign_{}", terms), assign + " = 0; return x; }");
+	}
+}
+
+void bench_statements()
+{
+	// 20k nested blocks, 20k nested ifs and an if with 100k else-if arms
+	// through the whole pipeline, bodies nest on the parser, printer and
+	// semantic own stacks instead of the call stack (the depth is lower
+	// than the chain since the printed indentation grows with it)
+
+	static constexpr int DEPTH = 20000,
+						 CHAIN_LENGTH = 100000;
+
+	std::string blocks = "i32 main() { i32 x = 0; ",
+				ifs = "i32 main() { i32 x = 0; ",
+				chain = "i32 main() { i32 x = 0; if (x == 0) { x = 1; }";
+
+	for (int i = 0; i < DEPTH; ++i)
+	{
+		blocks += "{ ";
+		ifs += "if (x < 1) { ";
+	}
+
+	for (int i = 0; i < CHAIN_LENGTH; ++i)
+		chain += std::format(" else if (x == {}) {{ x = {}; }}", i, i + 1);
+
+	blocks += "x = 1; " + std::string(DEPTH, '}');
+	ifs += "x = 1; " + std::string(DEPTH, '}');
+
+	auto bench_pipeline = [](const std::string& name, const std::string& source)
+	{
+		// same passes as 'compile', the printed trees are discarded so
+		// only walking and formatting them is measured
+
+		BenchPipeline pipeline(name, source);
+
+		{
+			PROFILE(std::format("Lexer Time ({})", name));
+			g_lexer->run(pipeline.filename);
+		}
+
+		{
+			PROFILE(std::format("Syntax Time ({})", name));
+			g_syntax->run();
+		}
+
+		{
+			PROFILE(std::format("Print Time ({})", name));
+
+			const auto flat_tree = ast::FlatTree(g_syntax->get_ast());
+
+			std::cout.setstate(std::ios::badbit);
+			ast::FlatPrinter().print(&flat_tree);
+			std::cout.clear();
+		}
+
+		{
+			PROFILE(std::format("Semantic Time ({})", name));
+			check(g_semantic->run(), "Semantic failed ({})", name);
+		}
+
+		{
+			PROFILE(std::format("Print Time after semantic ({})", name));
+
+			std::cout.setstate(std::ios::badbit);
+			g_syntax->print_ast();
+			std::cout.clear();
+		}
+	};
+
+	bench_pipeline("nested_blocks", blocks + " return x; }");
+	bench_pipeline("nested_ifs", ifs + " return x; }");
+	bench_pipeline("else_if_chain", chain + " else { x = 0; } return x; }");
+}
+
+void bench_lazy_bodies()
+{
+	// a library of 10k functions where main only calls 1 out of 100,
+	// lazy bodies only parse the ones reached from main
+
+	static constexpr int FUNCTIONS_COUNT = 10000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i32 fn{}(i32 a) {{ i32 b = a * {}; while (b > 10) {{ b = b / 2; }} if (b == 3) {{ b += a; }} else {{ b -= a; }} return b; }}\n", i, i);
+
+	source += "i32 main() { i32 x = 0;";
+
+	for (int i = 0; i < FUNCTIONS_COUNT; i += 100)
+		source += std::format(" x += fn{}(x);", i);
+
+	source += " return x; }";
+
+	for (bool lazy_bodies : { false, true })
+	{
+		BenchPipeline pipeline("lazy", source);
+
+		g_lexer->run(pipeline.filename);
+
+		{
+			PROFILE(std::format("Syntax + Semantic Time ({} bodies)", lazy_bodies ? "lazy" : "eager"));
+			g_syntax->run(lazy_bodies);
+			g_semantic->run();
+		}
+
+		PRINT(White, "{} unreached bodies skipped\n", g_semantic->get_skipped_count());
+	}
+}
+
+void bench_parallel_syntax()
+{
+	// 50k functions parsed with 1 to 16 threads
+
+	static constexpr int FUNCTIONS_COUNT = 50000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i32 fn{}(i32 a) {{ i32 b = a * {}; while (b > 10) {{ b = b / 2; }} if (b == 3) {{ b += a; }} else {{ b -= a; }} return b; }}\n", i, i);
+
+	BenchPipeline pipeline("parallel", source);
+
+	g_lexer->run(pipeline.filename);
+
+	for (size_t threads : { 1, 2, 4, 8, 16 })
+	{
+		g_syntax = std::make_unique<Syntax>();
+
+		PROFILE(std::format("Syntax Time ({} threads)", threads));
+		g_syntax->run(false, threads);
+	}
+}
+
+void bench_parallel_semantic()
+{
+	// 50k functions analyzed with 1 to 16 threads, every function calls
+	// the previous one so each body needs the prototypes table
+
+	static constexpr int FUNCTIONS_COUNT = 50000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i32 fn{0}(i32 a) {{ i64 b = a * {0}; while (b > 10) {{ b = b / 2; }} if (b == 3) {{ b += a; }} else {{ b -= a; }} return {1}; }}\n",
+			i, i > 0 ? std::format("fn{}(b)", i - 1) : "b");
+
+	for (size_t threads : { 1, 2, 4, 8, 16 })
+	{
+		BenchPipeline pipeline("parallel_semantic", source);
+
+		g_lexer->run(pipeline.filename);
+		g_syntax->run();
+
+		PROFILE(std::format("Semantic Time ({} threads)", threads));
+		g_semantic->run(threads);
+	}
+}
+
+void bench_constant_folding()
+{
+	// 20k functions full of constant expressions mixed with a parameter,
+	// the nodes left for the IR are counted before and after folding
+
+	static constexpr int FUNCTIONS_COUNT = 20000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i32 fn{0}(i32 a) {{ i64 b = (({0} * 4 + 16) << 2) / 3 - a; i8 c = {0} % 7 * 2 + 1; u16 d = (1 << 12) - {0} % 100 * 3; while (b > 1024 * 1024 - 1) {{ b = b / (2 + 2); }} return b + c + d + (24 - 8 * 3); }}\n", i);
+
+	BenchPipeline pipeline("constant_folding", source);
+
+	g_lexer->run(pipeline.filename);
+	g_syntax->run();
+
+	const auto nodes_before = ast::FlatTree(g_syntax->get_ast()).get_nodes_count();
+
+	{
+		PROFILE("Semantic Time (constant expressions)");
+		g_semantic->run();
+	}
 
-	PRINT(Cyan, "---------- Lexic Analysis ----------\n");
+	const auto nodes_after = ast::FlatTree(g_syntax->get_ast()).get_nodes_count();
+
+	PRINT(White, "nodes: {} parsed, {} after semantic\n", nodes_before, nodes_after);
+}
+
+void bench_types()
+{
+	// 20k functions mixing every integer type and a few pointers so most
+	// of the semantic time goes to common types and implicit casts
+
+	static constexpr int FUNCTIONS_COUNT = 20000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i64 fn{0}(u8 a, i16 b, u32 c, i64 d, i32* p) {{ i64 r = a + b * c - d; u16 e = a * b + c; i32** q = &p; p = p + a; r += *p + **q * e; return r + a - b + c * d; }}\n", i);
+
+	BenchPipeline pipeline("types", source);
+
+	g_lexer->run(pipeline.filename);
+	g_syntax->run();
+
+	{
+		PROFILE("Semantic Time (mixed types)");
+		g_semantic->run();
+	}
+
+	PRINT(White, "type handle: {} bytes, {} canonical types\n", sizeof(ast::Type), ast::TypeContext::TYPES_COUNT);
+}
+
+void bench_syntax_errors()
+{
+	// 50k functions without errors and with a missing ';' in 1 out of 100
+	// of them, recovering must not slow down the parse without errors and
+	// every error must be reported in the same pass
+
+	static constexpr int FUNCTIONS_COUNT = 50000;
+
+	for (bool typos : { false, true })
+	{
+		std::string source;
+
+		for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+			source += std::format("i32 fn{}(i32 a) {{ i32 b = a * {}{} while (b > 10) {{ b = b / 2; }} if (b == 3) {{ b += a; }} else {{ b -= a; }} return b; }}\n",
+				i, i, typos && i % 100 == 0 ? "" : ";");
+
+		BenchPipeline pipeline("syntax_errors", source);
+
+		g_lexer->run(pipeline.filename);
+
+		{
+			PROFILE(std::format("Syntax Time ({})", typos ? "500 errors" : "no errors"));
+			g_syntax->run();
+		}
+
+		PRINT(White, "{} syntax errors reported\n", g_syntax->get_errors_count());
+	}
+}
+
+void bench_scopes()
+{
+	// 2k functions nesting 64 blocks, every block shadows the names of the
+	// enclosing one and reads them before doing it
+
+	static constexpr int FUNCTIONS_COUNT = 2000,
+						 DEPTH = 64;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+	{
+		source += std::format("i32 fn{}(i32 a) {{ i32 x = a; i32 y = a;", i);
+
+		for (int j = 0; j < DEPTH; ++j)
+			source += std::format(" {{ i32 t = x + y; i32 y = t * {}; i32 x = y - a; if (x > 3) {{ i32 t = x; x = t / 2; }}", j);
+
+		source += std::string(DEPTH, '}') + " return x; }\n";
+	}
+
+	BenchPipeline pipeline("scopes", source);
+
+	g_lexer->run(pipeline.filename);
+	g_syntax->run();
+
+	bool ok = false;
 
 	{
-		PROFILE("Lexer Time");
-		g_lexer->run("test.ankh");
+		PROFILE("Semantic Time (nested scopes)");
+		ok = g_semantic->run();
 	}
 
-	g_lexer->print_errors();
-	g_lexer->print_list();
+	PRINT(White, "semantic analysis {}\n", ok ? "succeeded" : "failed");
+}
+
+void bench_incremental()
+{
+	// 10k functions calling the previous one and a few edits replayed on
+	// them, every version is updated in place and then compiled again
+	// from scratch to compare both latencies
+
+	static constexpr int FUNCTIONS_COUNT = 10000;
+
+	std::string source;
+
+	for (int i = 0; i < FUNCTIONS_COUNT; ++i)
+		source += std::format("i32 fn{0}(i32 a{0}) {{ i32 b = a{0} * {0}; while (b > 10) {{ b = b / 2; }} if (b == 3) {{ b += a{0}; }} else {{ b -= a{0}; }} return {1}; }}\n",
+			i, i > 0 ? std::format("fn{}(b)", i - 1) : "b");
+
+	source += "i32 main() { return fn9999(1); }";
+
+	auto edit = [](std::string v, const std::string& from, const std::string& to)
+	{
+		return v.replace(v.find(from), from.length(), to);
+	};
+
+	const std::vector<std::pair<std::string, std::string>> versions
+	{
+		{ "body", edit(source, "a5000 * 5000;", "a5000 * 5001;") },
+		{ "signature", edit(source, "i32 fn5000(i32 a5000)", "i32 fn5000(i64 a5000)") },
+		{ "insertion", edit(source, "i32 fn5000(", "i32 fn_new(i32 a) { return a; }\ni32 fn5000(") },
+		{ "removal", source },
+	};
+
+	{
+		BenchPipeline pipeline("incremental", source);
+
+		g_lexer->run(pipeline.filename);
+		g_syntax->run();
+		g_semantic->run();
+
+		for (const auto& [name, version] : versions)
+		{
+			PROFILE(std::format("Incremental Time ({})", name));
 
-	PRINT(Cyan, "\n---------- Syntax Analysis ----------\n");
+			const auto update = g_syntax->update(version);
+
+			check(update && g_semantic->update(*update), "Incremental update failed ({})", name);
+		}
+	}
 
+	for (int i = 0; const auto& [name, version] : versions)
 	{
-		PROFILE("Syntax Time");
+		BenchPipeline pipeline(std::format("incremental_{}", i++), version);
+
+		PROFILE(std::format("Full Rebuild Time ({})", name));
+		g_lexer->run(pipeline.filename);
 		g_syntax->run();
+		g_semantic->run();
+	}
+}
+
+void bench_ast()
+{
+	// builds and frees a tree of 1M nodes, a body full of 'a = b + 1'
+
+	static constexpr size_t NODES_COUNT = 1000000;
+
+	auto tree = _ALLOC(ast::AST);
+
+	{
+		PROFILE("AST Build Time (1M nodes)");
+
+		auto& arena = tree->arena;
+
+		auto body = arena.create<ast::StmtBody>();
+
+		tree->prototypes.push_back(arena.create<ast::Prototype>(Symbol(2), ast::Type(Type_i32)));
+		tree->prototypes.back()->body = body;
+
+		while (arena.get_nodes_count() < NODES_COUNT)
+		{
+			auto one = arena.create<ast::ExprIntLiteral>(Int { 1 }, ast::Type(Type_i32));
+			auto add = arena.create<ast::ExprBinaryOp>(arena.create<ast::ExprId>(Symbol(1)), one, BinOpType_Add, ast::Type(Type_i32));
+
+			body->stmts.push_back(arena.create<ast::ExprAssign>(arena.create<ast::ExprId>(Symbol(0)), add));
+		}
+	}
+
+	{
+		PROFILE("AST Flatten Time (1M nodes)");
+
+		ast::FlatTree flat_tree(tree);
+
+		PRINT(White, "flat tree: {} nodes, {} bytes\n", flat_tree.get_nodes_count(), flat_tree.get_size());
+	}
+
+	{
+		PROFILE("AST Free Time (1M nodes)");
+
+		_FREE(tree);
+	}
+}
+
+const std::vector<std::pair<std::string_view, void(*)()>> g_benches
+{
+	{ "lexer",				bench_lexer },
+	{ "ast",				bench_ast },
+	{ "identifiers",		bench_identifiers },
+	{ "expressions",		bench_expressions },
+	{ "statements",			bench_statements },
+	{ "lazy_bodies",		bench_lazy_bodies },
+	{ "parallel_syntax",	bench_parallel_syntax },
+	{ "parallel_semantic",	bench_parallel_semantic },
+	{ "incremental",		bench_incremental },
+	{ "syntax_errors",		bench_syntax_errors },
+	{ "scopes",				bench_scopes },
+	{ "constant_folding",	bench_constant_folding },
+	{ "types",				bench_types },
+};
+
+void run_benches(std::span<char*> names)
+{
+	// no names runs every bench in order
+
+	for (const auto& [name, bench] : g_benches)
+		if (names.empty() || std::ranges::any_of(names, [&](const char* v) { return v == name; }))
+		{
+			PRINT(Cyan, "---------- Bench '{}' ----------\n", name);
+
+			bench();
+		}
+
+	for (auto name : names)
+		if (std::ranges::none_of(g_benches, [&](const auto& v) { return v.first == name; }))
+			PRINT(Red, "Unknown bench '{}'\n", name);
+}
+
+void compile(const std::string& filename)
+{
+	// unchanged sources load their tree from the cache and skip the
+	// lexer and the parser
+
+	ast::Cache ast_cache("ast_cache");
+
+	const auto cache_key = ast_cache.get_key(filename);
+
+	bool cached = false,
+		 semantic_ok = false;
+
+	// the tree is printed straight from its flat form, the cache gives
+	// it back as it is and a fresh tree is flattened once for both
+
+	ast::FlatTree flat_tree;
+
+	if (cache_key)
+	{
+		PROFILE("AST Cache Load Time");
+
+		if ((cached = ast_cache.load(cache_key.value(), flat_tree)))
+			flat_tree.expand(g_syntax->get_ast());
+	}
+
+	if (cached)
+		PRINT(Cyan, "---------- AST loaded from cache ----------\n");
+	else
+	{
+		PRINT(Cyan, "---------- Lexic Analysis ----------\n");
+
+		{
+			PROFILE("Lexer Time");
+			g_lexer->run(filename, std::thread::hardware_concurrency());
+			PROFILE_BYTES(g_lexer->get_source_size());
+		}
+
+		if (g_lexer->has_errors())
+		{
+			g_lexer->print_errors();
+
+			return;
+		}
+
+		g_lexer->print_list();
+
+		PRINT(Cyan, "\n---------- Syntax Analysis ----------\n");
+
+		{
+			PROFILE("Syntax Time");
+			g_syntax->run(false, std::thread::hardware_concurrency());
+		}
+
+		if (g_syntax->has_errors())
+		{
+			g_syntax->print_errors();
+
+			return;
+		}
+
+		// semantic modifies the tree so it's stored as it comes out
+		// of the parser
+
+		flat_tree = ast::FlatTree(g_syntax->get_ast());
+
+		if (cache_key)
+			ast_cache.save(cache_key.value(), flat_tree);
 	}
 
 	PRINT(Cyan, "\n---------- AST ----------\n");
 
-	g_syntax->print_ast();
+	ast::FlatPrinter().print(&flat_tree);
 
-	const bool semantic_ok = g_semantic->run();
+	{
+		PROFILE("Semantic Time");
+		semantic_ok = g_semantic->run(std::thread::hardware_concurrency());
+	}
 
 
 	PRINT(Cyan, "\n---------- Semantic Analysis ----------\n");
 
+	if (const auto skipped = g_semantic->get_skipped_count())
+		PRINT(Yellow, "{} functions not reached from main were skipped\n", skipped);
+
 	if (!semantic_ok)
 	{
 		g_semantic->print_errors();
 
-		goto finish;
+		return;
 	}
 
 	PRINT(Cyan, "\n---------- AST after semantic ----------\n");
@@ -91,17 +702,36 @@ int main()
 	//g_ir->print();
 
 	test_ir();
+}
+
+int main(int argc, char** argv)
+{
+	setup_console();
 
-finish:
+	g_symbols = std::make_unique<SymbolTable>();
+	g_types = std::make_unique<ast::TypeContext>();
+	g_intrin = std::make_unique<Intrinsic>();
+	g_lexer = std::make_unique<Lexer>();
+	g_syntax = std::make_unique<Syntax>();
+	g_semantic = std::make_unique<Semantic>();
+	//g_ir = std::make_unique<IR>();
+
+	// 'ankh --bench [names...]' runs benches instead of compiling
+
+	if (argc > 1 && std::string_view(argv[1]) == "--bench")
+		run_benches(std::span(argv + 2, argv + argc));
+	else compile("test.ankh");
 
 	//g_ir.reset();
 	g_semantic.reset();
 	g_syntax.reset();
 	g_lexer.reset();
 	g_intrin.reset();
+	g_types.reset();
+	g_symbols.reset();
 
 	if (!mem::check_and_dump_memory_leaks())
 		std::cin.get();
 
 	return std::cin.get();
-}
\ No newline at end of file
+}
@@ -52,6 +52,21 @@ namespace mem
 		return instance;
 	}
 
+	// same as 'alloc_pool' but default initialized, trivial types are left
+	// untouched instead of being zeroed
+
+	template <typename T>
+	T* alloc_pool_uninit(const std::source_location& src, size_t size)
+	{
+		auto instance = new(std::nothrow) T[size];
+		if (!instance)
+			throw_alloc_error();
+
+		save_allocation(src, typeid(T).name(), instance, sizeof(T) * size, true);
+
+		return instance;
+	}
+
 	template <typename T>
 	void free(T* instance)
 	{
@@ -77,6 +92,7 @@ namespace mem
 
 #define _ALLOC(type, ...)			mem::alloc<type>(std::source_location::current(), __VA_ARGS__)
 #define _ALLOC_POOL(type, size)		mem::alloc_pool<type>(std::source_location::current(), size)
+#define _ALLOC_POOL_UNINIT(type, size)	mem::alloc_pool_uninit<type>(std::source_location::current(), size)
 #define _FREE						mem::free
 #define _FREE_R(x)					{ mem::free(x); x = nullptr; }
 #define _FREE_POOL					mem::free_pool
\ No newline at end of file
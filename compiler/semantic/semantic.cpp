@@ -3,6 +3,136 @@
 #include "semantic.h"
 
 #include <syntax/syntax.h>
+#include <ast/visitor.h>
+
+namespace semantic
+{
+	/*
+	* truncates 'v' to the width of 'type' the way the target register
+	* would, signed values are kept sign extended to 64 bits and unsigned
+	* values zero extended
+	*/
+	uint64_t wrap(uint64_t v, const ast::Type& type)
+	{
+		const auto bits = type.get_size();
+
+		if (bits >= 64)
+			return v;
+
+		const auto mask = (1ull << bits) - 1ull;
+
+		v &= mask;
+
+		if (type.is_signed() && (v >> (bits - 1ull)) & 1ull)
+			v |= ~mask;
+
+		return v;
+	}
+
+	/*
+	* whether the value 'v' of type 'from' is the same value once it's
+	* wrapped to 'to', a change of signedness only keeps non negative values
+	*/
+	bool fits(uint64_t v, const ast::Type& from, const ast::Type& to)
+	{
+		return wrap(v, to) == v && (from.is_signed() == to.is_signed() || static_cast<int64_t>(v) >= 0);
+	}
+
+	bool is_constant_type(const ast::Type& type)
+	{
+		return type.get_indirection() == 0 && type.is_arithmetic();
+	}
+
+	bool is_foldable(ast::Expr* expr)
+	{
+		return expr->stmt_type == ast::StmtExpr_IntLiteral && is_constant_type(expr->type);
+	}
+
+	uint64_t get_literal(ast::Expr* expr)
+	{
+		return wrap(static_cast<ast::ExprIntLiteral*>(expr)->integer.u64, expr->type);
+	}
+
+	// the result of a fold is written over one of the literals it comes
+	// from, every literal has a single parent so folding never allocates
+
+	ast::Expr* set_literal(ast::Expr* expr, uint64_t value, const ast::Type& type)
+	{
+		auto literal = static_cast<ast::ExprIntLiteral*>(expr);
+
+		literal->integer.u64 = wrap(value, type);
+		literal->type = type;
+
+		return literal;
+	}
+
+	// both operands have the common type of the operation already, the
+	// divisions the target would trap on are left for the runtime (by zero
+	// and the signed minimum of the operand width by -1)
+
+	std::optional<uint64_t> fold_binary(BinOpType op, uint64_t a, uint64_t b, const ast::Type& type)
+	{
+		const auto sa = static_cast<int64_t>(a),
+				   sb = static_cast<int64_t>(b);
+
+		const bool is_signed = type.is_signed();
+
+		// signed values are sign extended so the minimum of every width
+		// is the same negative value in 64 bits
+
+		const auto signed_min = static_cast<int64_t>(~0ull << (type.get_size() - 1ull));
+
+		// x86 masks the shift count to 5 bits unless the operand is 64 bits
+
+		const auto shift = b & (type.get_size() == 64ull ? 63ull : 31ull);
+
+		switch (op)
+		{
+		case BinOpType_Add:			return a + b;
+		case BinOpType_Sub:			return a - b;
+		case BinOpType_Mul:			return a * b;
+		case BinOpType_Div:
+		case BinOpType_Mod:
+		{
+			if (b == 0ull || (is_signed && sb == -1ll && sa == signed_min))
+				return std::nullopt;
+
+			if (op == BinOpType_Div)
+				return (is_signed ? static_cast<uint64_t>(sa / sb) : a / b);
+
+			return (is_signed ? static_cast<uint64_t>(sa % sb) : a % b);
+		}
+		case BinOpType_And:			return a & b;
+		case BinOpType_Or:			return a | b;
+		case BinOpType_Xor:			return a ^ b;
+		case BinOpType_Shl:			return a << shift;
+		case BinOpType_Shr:			return (is_signed ? static_cast<uint64_t>(sa >> shift) : a >> shift);
+		case BinOpType_Equal:		return a == b;
+		case BinOpType_NotEqual:	return a != b;
+		case BinOpType_Lt:			return (is_signed ? sa < sb : a < b);
+		case BinOpType_Lte:			return (is_signed ? sa <= sb : a <= b);
+		case BinOpType_Gt:			return (is_signed ? sa > sb : a > b);
+		case BinOpType_Gte:			return (is_signed ? sa >= sb : a >= b);
+		case BinOpType_LogicalAnd:	return a && b;
+		case BinOpType_LogicalOr:	return a || b;
+		}
+
+		return std::nullopt;
+	}
+
+	std::optional<uint64_t> fold_unary(UnaryOpType op, uint64_t v)
+	{
+		switch (op)
+		{
+		case UnaryOpType_Add:			return v;
+		case UnaryOpType_Sub:			return 0ull - v;
+		case UnaryOpType_Not:			return ~v;
+		case UnaryOpType_LogicalNot:	return v == 0ull;
+		}
+
+		return std::nullopt;
+	}
+}
 
 void Semantic::print_errors()
 {
@@ -12,98 +142,240 @@ void Semantic::print_errors()
 
 void Semantic::enter_scope()
 {
+	p_ctx.scopes.enter();
 }
 
 void Semantic::exit_scope()
 {
+	p_ctx.scopes.exit();
 }
 
-void Semantic::analyze_function(ast::Prototype* function)
+void Semantic::reach_function(ast::Prototype* function)
 {
-	p_ctx = function;
+	if (reached_functions.insert(function).second)
+		reachable_functions.push_back(function);
+}
+
+void Semantic::analyze_prototype(ast::Prototype* prototype)
+{
+	if (!g_syntax->get_body(prototype))
+		return add_error("Function {} doesn't have a body.", prototype->name.str());
 
-	for (auto parameter : function->params) 
-		p_ctx.set_id_type(parameter->name, parameter->type);
+	// a failed check drops the rest of the function and it's reported
+	// along with the other errors, whatever thread analyzed the function
 
-	analyze_body(function->body, semantic::BodyData {});
+	try
+	{
+		analyze_function(prototype);
+	}
+	catch (const compiler_exception& e)
+	{
+		add_error("{}", e.what());
+	}
 }
 
-void Semantic::analyze_body(ast::StmtBody* body, semantic::BodyData body_data)
+void Semantic::analyze_function(ast::Prototype* function)
 {
-	if (!body)
-		return;
+	// frames left by a function that threw are dropped along with its scopes
+
+	p_ctx = function;
+
+	stmt_frames.clear();
+
+	// the parameters share the outermost scope with the locals of the
+	// body so a local can't redefine them
 
 	enter_scope();
 
-	for (auto stmt : body->stmts)
-		analyze_stmt(stmt, body_data);
+	for (auto parameter : function->params)
+		if (!p_ctx.declare(parameter))
+			add_error("Identifier '{}' redefined", parameter->name.str());
+
+	for (auto stmt : function->body->stmts)
+		analyze_stmt(stmt, semantic::BodyData {});
 
 	exit_scope();
 }
 
 void Semantic::analyze_stmt(ast::Base* stmt, semantic::BodyData data)
 {
-	if (auto body = rtti::cast<ast::StmtBody>(stmt))					analyze_body(body, semantic::BodyData { data.depth + 1, data.is_in_loop });
-	else if (auto expr = rtti::cast<ast::Expr>(stmt))					analyze_expr(expr);
-	else if (auto stmt_if = rtti::cast<ast::StmtIf>(stmt))				analyze_if(stmt_if, data);
-	else if (auto stmt_for = rtti::cast<ast::StmtFor>(stmt))			analyze_for(stmt_for, data);
-	else if (auto stmt_while = rtti::cast<ast::StmtWhile>(stmt))		analyze_while(stmt_while, data);
-	else if (auto stmt_do_while = rtti::cast<ast::StmtDoWhile>(stmt))	analyze_do_while(stmt_do_while, data);
-	else if (auto stmt_return = rtti::cast<ast::StmtReturn>(stmt))		analyze_return(stmt_return, data);
-	else if (rtti::cast<ast::StmtContinue>(stmt) || rtti::cast<ast::StmtBreak>(stmt))
+	// compound statements are frames in 'stmt_frames' instead of calls so
+	// the nesting depth is only limited by memory, frames below 'base'
+	// belong to the caller
+
+	const auto base = stmt_frames.size();
+
+	open_stmt(stmt, data);
+
+	while (stmt_frames.size() > base)
+	{
+		const auto frame = stmt_frames.back();
+
+		++stmt_frames.back().step;
+
+		bool done = true;
+
+		ast::visit_stmt(frame.stmt, ast::Visitor
+		{
+			[&](ast::StmtBody* body)					{ done = analyze_body(body, frame.data, frame.step); },
+			[&](ast::StmtIf* stmt_if)					{ done = analyze_if(stmt_if, frame.data, frame.step); },
+			[&](ast::StmtFor* stmt_for)					{ done = analyze_for(stmt_for, frame.data, frame.step); },
+			[&](ast::StmtWhile* stmt_while)				{ done = analyze_while(stmt_while, frame.data, frame.step); },
+			[&](ast::StmtDoWhile* stmt_do_while)		{ done = analyze_do_while(stmt_do_while, frame.data, frame.step); },
+			[&](ast::Expr*)								{},
+			[&](ast::StmtReturn*)						{},
+			[&](ast::StmtContinue*)						{},
+			[&](ast::StmtBreak*)						{},
+		});
+
+		// the last step of a statement never opens another one so the
+		// frame on top is still its own
+
+		if (done)
+			stmt_frames.pop_back();
+	}
+}
+
+void Semantic::open_stmt(ast::Base* stmt, semantic::BodyData data)
+{
+	if (!stmt)
+		return;
+
+	auto analyze_loop_control = [&]()
 	{
 		if (!data.is_in_loop)
 			add_error("Cannot use continue and break when not in loop.");
-	}
+	};
+
+	ast::visit_stmt(stmt, ast::Visitor
+	{
+		[&](ast::StmtBody* body)					{ open_body(body, semantic::BodyData { data.depth + 1, data.is_in_loop }); },
+		[&](ast::Expr* expr)						{ analyze_expr(expr); },
+		[&](ast::StmtIf* stmt_if)					{ stmt_frames.push_back({ stmt_if, data }); },
+		[&](ast::StmtFor* stmt_for)					{ stmt_frames.push_back({ stmt_for, data }); },
+		[&](ast::StmtWhile* stmt_while)				{ stmt_frames.push_back({ stmt_while, data }); },
+		[&](ast::StmtDoWhile* stmt_do_while)		{ stmt_frames.push_back({ stmt_do_while, data }); },
+		[&](ast::StmtReturn* stmt_return)			{ analyze_return(stmt_return, data); },
+		[&](ast::StmtContinue*)						{ analyze_loop_control(); },
+		[&](ast::StmtBreak*)						{ analyze_loop_control(); },
+	});
 }
 
-void Semantic::analyze_if(ast::StmtIf* stmt, semantic::BodyData data)
+void Semantic::open_body(ast::StmtBody* body, semantic::BodyData data)
 {
-	enter_scope();
+	if (body)
+		stmt_frames.push_back({ body, data });
+}
 
-	analyze_expr(stmt->expr);
+bool Semantic::analyze_body(ast::StmtBody* body, semantic::BodyData data, uint32_t step)
+{
+	if (step == 0)
+		enter_scope();
+	else if (step <= body->stmts.size())
+		open_stmt(body->stmts[step - 1], data);
+	else
+	{
+		exit_scope();
 
-	for (auto if_ : stmt->ifs)
-		analyze_if(if_, data);
+		return true;
+	}
+
+	return false;
+}
 
+bool Semantic::analyze_if(ast::StmtIf* stmt, semantic::BodyData data, uint32_t step)
+{
+	// the condition, every 'else if', the 'if' body and the 'else' body
+
+	const auto else_ifs_count = stmt->ifs.size();
 	const auto new_data = semantic::BodyData { data.depth + 1, data.is_in_loop };
 
-	analyze_body(stmt->if_body, new_data);
-	analyze_body(stmt->else_body, new_data);
+	if (step == 0)
+	{
+		enter_scope();
+
+		fold_replace(stmt->expr);
+	}
+	else if (step <= else_ifs_count)
+		open_stmt(stmt->ifs[step - 1], data);
+	else if (step == else_ifs_count + 1)
+		open_body(stmt->if_body, new_data);
+	else if (step == else_ifs_count + 2)
+		open_body(stmt->else_body, new_data);
+	else
+	{
+		exit_scope();
 
-	exit_scope();
+		return true;
+	}
+
+	return false;
 }
 
-void Semantic::analyze_for(ast::StmtFor* stmt, semantic::BodyData data)
+bool Semantic::analyze_for(ast::StmtFor* stmt, semantic::BodyData data, uint32_t step)
 {
-	enter_scope();
+	switch (step)
+	{
+	case 0:
+	{
+		enter_scope();
+
+		open_stmt(stmt->init, data);
+
+		return false;
+	}
+	case 1:
+	{
+		fold_replace(stmt->condition);
+		open_stmt(stmt->step, data);
 
-	analyze_stmt(stmt->init, data);
-	analyze_expr(stmt->condition);
-	analyze_stmt(stmt->step, data);
-	analyze_body(stmt->body, semantic::BodyData { data.depth + 1, true });
+		return false;
+	}
+	case 2:
+	{
+		open_body(stmt->body, semantic::BodyData { data.depth + 1, true });
+
+		return false;
+	}
+	}
 
 	exit_scope();
+
+	return true;
 }
 
-void Semantic::analyze_while(ast::StmtWhile* stmt, semantic::BodyData data)
+bool Semantic::analyze_while(ast::StmtWhile* stmt, semantic::BodyData data, uint32_t step)
 {
-	enter_scope();
+	if (step == 0)
+	{
+		enter_scope();
+
+		fold_replace(stmt->condition);
+		open_body(stmt->body, semantic::BodyData { data.depth + 1, true });
 
-	analyze_expr(stmt->condition);
-	analyze_body(stmt->body, semantic::BodyData { data.depth + 1, true });
+		return false;
+	}
 
 	exit_scope();
+
+	return true;
 }
 
-void Semantic::analyze_do_while(ast::StmtDoWhile* stmt, semantic::BodyData data)
+bool Semantic::analyze_do_while(ast::StmtDoWhile* stmt, semantic::BodyData data, uint32_t step)
 {
-	enter_scope();
+	if (step == 0)
+	{
+		enter_scope();
+
+		fold_replace(stmt->condition);
+		open_body(stmt->body, semantic::BodyData { data.depth + 1, true });
 
-	analyze_expr(stmt->condition);
-	analyze_body(stmt->body, semantic::BodyData { data.depth + 1, true });
+		return false;
+	}
 
 	exit_scope();
+
+	return true;
 }
 
 void Semantic::analyze_return(ast::StmtReturn* stmt, semantic::BodyData data)
@@ -111,26 +383,36 @@ void Semantic::analyze_return(ast::StmtReturn* stmt, semantic::BodyData data)
 	const auto& return_type = p_ctx.pt->type;
 
 	if (stmt->expr)
+	{
+		analyze_expr(stmt->expr);
 		implicit_cast_replace(stmt->expr, return_type);
+	}
 	else if (return_type == Type_Void)
 		add_error("Cannot return void from non void function.");
 }
 
 void Semantic::analyze_expr(ast::Expr* expr)
 {
-	if (!expr || p_ctx.analyzed_exprs.find(expr) != p_ctx.analyzed_exprs.end())
+	// every node is analyzed once by its parent, the epoch only guards
+	// against a node reached twice within the same run
+
+	if (!expr || expr->analyzed_epoch == epoch)
 		return;
 
-	p_ctx.analyzed_exprs.insert(expr);
+	expr->analyzed_epoch = epoch;
 
-	if (auto c_expr = rtti::cast<ast::ExprId>(expr))				analyze_expr_id(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprDecl>(expr))			analyze_expr_decl(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprAssign>(expr))		analyze_expr_assign(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprBinaryAssign>(expr)) analyze_expr_bin_assign(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprBinaryOp>(expr))		analyze_expr_bin_op(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprUnaryOp>(expr))		analyze_expr_unary_op(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprCall>(expr))			analyze_expr_call(c_expr);
-	else if (auto c_expr = rtti::cast<ast::ExprCast>(expr))			analyze_expr_cast(c_expr);
+	ast::visit_expr(expr, ast::Visitor
+	{
+		[&](ast::ExprIntLiteral*)					{},
+		[&](ast::ExprId* c_expr)					{ analyze_expr_id(c_expr); },
+		[&](ast::ExprDecl* c_expr)					{ analyze_expr_decl(c_expr); },
+		[&](ast::ExprAssign* c_expr)				{ analyze_expr_assign(c_expr); },
+		[&](ast::ExprBinaryAssign* c_expr)			{ analyze_expr_bin_assign(c_expr); },
+		[&](ast::ExprBinaryOp* c_expr)				{ analyze_expr_bin_op(c_expr); },
+		[&](ast::ExprUnaryOp* c_expr)				{ analyze_expr_unary_op(c_expr); },
+		[&](ast::ExprCall* c_expr)					{ analyze_expr_call(c_expr); },
+		[&](ast::ExprCast* c_expr)					{ analyze_expr_cast(c_expr); },
+	});
 
 	//check(expr->type.type != Type_None, "???");
 }
@@ -142,14 +424,12 @@ void Semantic::analyze_expr_id(ast::ExprId* expr)
 
 void Semantic::analyze_expr_decl(ast::ExprDecl* expr) 
 {
-	if (p_ctx.get_id_type(expr->name))
-		add_error("Identifier '{}' redefined", expr->name);
-	else
+	if (!p_ctx.declare(expr))
+		add_error("Identifier '{}' redefined", expr->name.str());
+	else if (expr->rhs)
 	{
-		p_ctx.set_id_type(expr->name, expr->type);
-
-		if (expr->rhs)
-			implicit_cast_replace(expr->rhs, expr->type);
+		analyze_expr(expr->rhs);
+		implicit_cast_replace(expr->rhs, expr->type);
 	}
 }
 
@@ -157,6 +437,7 @@ void Semantic::analyze_expr_assign(ast::ExprAssign* expr)
 {
 	const auto& lhs_type = expr->type = get_expr_type(expr->lhs);
 
+	analyze_expr(expr->rhs);
 	implicit_cast_replace(expr->rhs, lhs_type);
 }
 
@@ -164,6 +445,7 @@ void Semantic::analyze_expr_bin_assign(ast::ExprBinaryAssign* expr)
 {
 	const auto& lhs_type = expr->type = get_expr_type(expr->lhs);
 
+	analyze_expr(expr->rhs);
 	implicit_cast_replace(expr->rhs, lhs_type);
 }
 
@@ -180,22 +462,22 @@ void Semantic::analyze_expr_bin_op(ast::ExprBinaryOp* expr)
 
 	if (lhs_arithmetic && rhs_arithmetic && !lhs_ptr && !rhs_ptr)
 	{
-		const auto& common_type = expr->type = *lhs_type.binary_implicit_cast(rhs_type);
+		const auto& common_type = expr->type = g_types->get_common_type(lhs_type, rhs_type);
 
 		implicit_cast_replace(expr->lhs, common_type);
 		implicit_cast_replace(expr->rhs, common_type);
 	}
 	else if (expr->op == BinOpType_Add)
 	{
-		if (lhs_arithmetic && rhs_ptr && !lhs_ptr)		expr->type = ast::Type(rhs_type.type, rhs_type.indirection);
-		else if (rhs_arithmetic && lhs_ptr && !rhs_ptr) expr->type = ast::Type(lhs_type.type, lhs_type.indirection);
+		if (lhs_arithmetic && rhs_ptr && !lhs_ptr)		expr->type = rhs_type;
+		else if (rhs_arithmetic && lhs_ptr && !rhs_ptr) expr->type = lhs_type;
 		else											add_error("Invalid binary operation");
 	}
 	else if (expr->op == BinOpType_Sub)
 	{
 		if (rhs_ptr && lhs_ptr)				expr->type = ast::Type(Type_i64);
-		else if (lhs_arithmetic && rhs_ptr)	expr->type = ast::Type(rhs_type.type, rhs_type.indirection);
-		else if (rhs_arithmetic && lhs_ptr) expr->type = ast::Type(lhs_type.type, lhs_type.indirection);
+		else if (lhs_arithmetic && rhs_ptr)	expr->type = rhs_type;
+		else if (rhs_arithmetic && lhs_ptr) expr->type = lhs_type;
 		else								add_error("Invalid binary operation");
 	}
 	else add_error("Binary operation must have arithmetic types only");
@@ -203,19 +485,25 @@ void Semantic::analyze_expr_bin_op(ast::ExprBinaryOp* expr)
 
 void Semantic::analyze_expr_unary_op(ast::ExprUnaryOp* expr) 
 {
-	auto type = get_expr_type(expr->lhs ? expr->lhs : expr->rhs);
+	auto& operand = (expr->lhs ? expr->lhs : expr->rhs);
+
+	analyze_expr(operand);
+
+	operand = fold(operand);
+
+	auto type = operand->type;
 
 	switch (expr->op)
 	{
 	case UnaryOpType_Mul:
 	{
-		check(type.indirection > 0, "Cannot deref non-pointer");
+		check(type.get_indirection() > 0, "Cannot deref non-pointer");
 		type.decrease_indirection();
 		break;
 	}
 	case UnaryOpType_And:
 	{
-		type.increase_indirection();
+		check(type.increase_indirection(), "Too many indirections");
 		break;
 	}
 	case UnaryOpType_Dec:
@@ -236,19 +524,24 @@ void Semantic::analyze_expr_call(ast::ExprCall* expr)
 	for (auto param : expr->exprs)
 		analyze_expr(param);
 
-	if (const auto prototype = g_ctx.get_prototype(expr->name))
+	callers[expr->name].insert(p_ctx.pt);
+
+	if (const auto prototype = g_ctx->get_prototype(expr->name))
 	{
 		check(expr->exprs.size() == prototype->params.size(), "Invalid parameter count.");
 
 		for (int i = 0; i < expr->exprs.size(); ++i)
-			implicit_cast_replace(expr->exprs[i], get_expr_type(prototype->params[i]));
+			implicit_cast_replace(expr->exprs[i], prototype->params[i]->type);
 
 		expr->prototype = prototype;
 		expr->type = prototype->type;
+
+		if (g_syntax->has_lazy_bodies())
+			reach_function(prototype);
 	}
 	else
 	{
-		add_error("Cannot call unknown function {}.", expr->name);
+		add_error("Cannot call unknown function {}.", expr->name.str());
 		return;
 	}
 }
@@ -256,6 +549,8 @@ void Semantic::analyze_expr_call(ast::ExprCall* expr)
 void Semantic::analyze_expr_cast(ast::ExprCast* expr)
 {
 	analyze_expr(expr->rhs);
+
+	expr->rhs = fold(expr->rhs);
 }
 
 ast::Type Semantic::get_expr_type(ast::Expr* expr)
@@ -267,70 +562,290 @@ ast::Type Semantic::get_expr_type(ast::Expr* expr)
 	return expr->type;
 }
 
-ast::Type Semantic::get_id_type(const std::string& id)
+ast::Type Semantic::get_id_type(Symbol id)
 {
 	if (auto type = p_ctx.get_id_type(id))
 		return *type;
 
-	add_error("Undefined identifier '{}' used", id);
+	add_error("Undefined identifier '{}' used", id.str());
 
 	return ast::Type();
 }
 
 ast::Expr* Semantic::implicit_cast(ast::Expr* expr, const ast::Type& type)
 {
-	const auto& source_type = get_expr_type(expr);
-
-	if (source_type == type)
-		return expr;
+	// the expression is already analyzed by the caller
 
-	if (source_type.indirection > 0 || type.indirection > 0)
+	switch (g_types->get_implicit_cast(expr->type, type))
 	{
-		add_error("Cannot implicit cast pointers.");
-		return expr;
+	case ast::ImplicitCast_Cast:	return arena->create<ast::ExprCast>(expr, type, true);
+	case ast::ImplicitCast_Invalid:	add_error("Cannot implicit cast pointers."); break;
 	}
 
-	return _ALLOC(ast::ExprCast, expr, type, true);
+	return expr;
 }
 
 void Semantic::implicit_cast_replace(ast::Expr*& expr, const ast::Type& type)
 {
-	expr = implicit_cast(expr, type);
+	// constants take the new type instead of getting a cast
+
+	expr = fold(expr);
+
+	if (semantic::is_foldable(expr) && semantic::is_constant_type(type))
+	{
+		const auto value = semantic::get_literal(expr);
+
+		if (!semantic::fits(value, expr->type, type))
+		{
+			if (expr->type.is_signed())
+				add_error("Constant '{}' doesn't fit in '{}'", static_cast<int64_t>(value), type.str());
+			else add_error("Constant '{}' doesn't fit in '{}'", value, type.str());
+		}
+
+		semantic::set_literal(expr, value, type);
+	}
+	else expr = implicit_cast(expr, type);
+}
+
+ast::Expr* Semantic::fold(ast::Expr* expr)
+{
+	// operands are folded by the time their parent is analyzed so only
+	// the node itself is checked, the result is a literal when all its
+	// operands are literals and the expression itself otherwise
+
+	if (!expr)
+		return expr;
+
+	return ast::visit_expr(expr, ast::Visitor
+	{
+		[&](ast::ExprBinaryOp* bin_op) -> ast::Expr*
+		{
+			if (!semantic::is_constant_type(bin_op->type) || !semantic::is_foldable(bin_op->lhs) || !semantic::is_foldable(bin_op->rhs))
+				return bin_op;
+
+			const auto result = semantic::fold_binary(bin_op->op, semantic::get_literal(bin_op->lhs), semantic::get_literal(bin_op->rhs), bin_op->lhs->type);
+
+			return (result ? semantic::set_literal(bin_op->lhs, *result, bin_op->type) : bin_op);
+		},
+		[&](ast::ExprUnaryOp* unary_op) -> ast::Expr*
+		{
+			const auto operand = (unary_op->lhs ? unary_op->lhs : unary_op->rhs);
+
+			if (!semantic::is_constant_type(unary_op->type) || !semantic::is_foldable(operand))
+				return unary_op;
+
+			const auto result = semantic::fold_unary(unary_op->op, semantic::get_literal(operand));
+
+			return (result ? semantic::set_literal(operand, *result, unary_op->type) : unary_op);
+		},
+		[&](ast::ExprCast* cast) -> ast::Expr*
+		{
+			if (!semantic::is_constant_type(cast->type) || !semantic::is_foldable(cast->rhs))
+				return cast;
+
+			return semantic::set_literal(cast->rhs, semantic::get_literal(cast->rhs), cast->type);
+		},
+		[&](auto other) -> ast::Expr* { return other; },
+	});
+}
+
+void Semantic::fold_replace(ast::Expr*& expr)
+{
+	analyze_expr(expr);
+
+	if (expr)
+		expr = fold(expr);
 }
 
-bool Semantic::run()
+bool Semantic::run(size_t threads)
 {
+	epoch = ++last_epoch;
+
 	ast = g_syntax->get_ast();
+	arena = &ast->arena;
 
-	for (auto prototype : ast->prototypes)
-		g_ctx.add_prototype(prototype);
+	// every signature is known before any body is analyzed
 
 	for (auto prototype : ast->prototypes)
+		g_ctx->add_prototype(prototype);
+
+	if (g_syntax->has_lazy_bodies())
 	{
-		if (prototype->body)
-			analyze_function(prototype);
-		else add_error("Function {} doesn't have a body.", prototype->name);
+		// only main and the functions it reaches through calls get their
+		// bodies parsed and analyzed, the list grows while it's analyzed,
+		// a source without main (a library) has every function checked
+
+		if (auto main = g_ctx->get_prototype(g_symbols->find("main")))
+			reach_function(main);
+		else for (auto prototype : ast->prototypes)
+			reach_function(prototype);
+
+		for (size_t i = 0; i < reachable_functions.size(); ++i)
+			analyze_prototype(reachable_functions[i]);
 	}
+	else if (threads > 1)
+		analyze_functions(threads);
+	else for (auto prototype : ast->prototypes)
+		analyze_prototype(prototype);
 
 	p_ctx = nullptr;
 
 	return errors.empty();
 }
 
-void semantic::PrototypeInfo::set_id_type(const std::string& id, const ast::Type& type)
+size_t Semantic::get_skipped_count() const
 {
-	if (auto it = id_types.find(id); it == id_types.end())
-		id_types[id] = type;
-	else if (it->second != type)
-		g_semantic->add_error("ID {} has differing types.", id);
+	if (!ast || !g_syntax->has_lazy_bodies())
+		return 0;
+
+	return std::ranges::count_if(ast->prototypes, [&](ast::Prototype* prototype) { return !reached_functions.contains(prototype); });
 }
 
-ast::TypeOpt semantic::PrototypeInfo::get_id_type(const std::string& id)
+void Semantic::analyze_functions(size_t threads)
 {
-	auto it = id_types.find(id);
+	// bodies only read the prototypes table so every worker is an
+	// analyzer of its own (function context, errors, callers and arena)
+	// taking the next pending function until there are none left
 
-	if (it == id_types.end())
-		return std::nullopt;
+	const auto& prototypes = ast->prototypes;
+
+	std::vector<std::unique_ptr<Semantic>> analyzers(std::min(threads, prototypes.size()));
+	std::vector<ast::Arena> arenas(analyzers.size());
+	std::vector<std::future<void>> workers;
+	std::vector<std::vector<std::string>> function_errors(prototypes.size());
+
+	std::atomic_size_t next_function = 0;
+
+	for (size_t i = 0; i < analyzers.size(); ++i)
+	{
+		auto& analyzer = analyzers[i];
+
+		analyzer = std::make_unique<Semantic>();
+		analyzer->g_ctx = g_ctx;
+		analyzer->ast = ast;
+		analyzer->arena = &arenas[i];
+		analyzer->epoch = epoch;
+
+		workers.push_back(std::async(std::launch::async, [&, analyzer = analyzer.get()]()
+		{
+			for (size_t i = next_function++; i < prototypes.size(); i = next_function++)
+			{
+				analyzer->analyze_prototype(prototypes[i]);
+
+				function_errors[i] = std::move(analyzer->errors);
+
+				analyzer->errors.clear();
+			}
+		}));
+	}
+
+	// the casts are moved to the tree arena before reporting any error
+	// so they outlive the workers
+
+	for (auto& worker : workers)
+		worker.wait();
+
+	for (size_t i = 0; i < analyzers.size(); ++i)
+	{
+		ast->arena.merge(arenas[i]);
+
+		for (auto& [name, list] : analyzers[i]->callers)
+			callers[name].insert(list.begin(), list.end());
+	}
+
+	for (auto& worker : workers)
+		worker.get();
+
+	// errors are reported in source order whatever worker found them
+
+	for (const auto& list : function_errors)
+		errors.insert(errors.end(), list.begin(), list.end());
+}
+
+bool Semantic::update(const syntax::Update& update)
+{
+	// the functions parsed again are analyzed along with the callers of
+	// the names whose signature changed, everything else keeps the result
+	// of the previous run so it must have been a run without errors
+
+	if (!errors.empty() || g_syntax->has_lazy_bodies())
+		return false;
+
+	epoch = ++last_epoch;
+
+	for (auto prototype : update.removed)
+	{
+		g_ctx->remove_prototype(prototype);
+
+		for (auto& [name, list] : callers)
+			list.erase(prototype);
+	}
+
+	for (auto prototype : update.changed)
+		g_ctx->add_prototype(prototype);
+
+	auto pending = update.changed;
+	auto queued = std::unordered_set<ast::Prototype*>(pending.begin(), pending.end());
+
+	for (auto name : update.signatures)
+	{
+		const auto it = callers.find(name);
+
+		if (it == callers.end())
+			continue;
+
+		// the casts of the previous analysis are based on the old
+		// signature so the callers start again from a fresh body
+
+		for (auto caller : it->second)
+			if (queued.insert(caller).second)
+			{
+				g_syntax->reparse_body(caller);
+				pending.push_back(caller);
+			}
+	}
+
+	for (auto prototype : pending)
+		analyze_prototype(prototype);
+
+	p_ctx = nullptr;
+
+	return errors.empty();
+}
+
+void semantic::ScopeStack::truncate(size_t size)
+{
+	for (auto i = entries.size(); i > size; --i)
+	{
+		const auto& entry = entries[i - 1];
+
+		heads[entry.name.id] = entry.shadowed;
+	}
+
+	entries.resize(size);
+}
+
+bool semantic::ScopeStack::declare(Symbol name, const ast::Type& type, ast::Expr* decl)
+{
+	if (name.id >= heads.size())
+		heads.resize(std::max<size_t>(name.id + 1, g_symbols->get_symbols_count()), NONE);
+
+	auto& head = heads[name.id];
+
+	if (head != NONE && head >= (marks.empty() ? 0 : marks.back()))
+		return false;
+
+	entries.push_back({ name, type, decl, head });
+
+	head = static_cast<uint32_t>(entries.size() - 1);
+
+	return true;
+}
+
+ast::TypeOpt semantic::PrototypeInfo::get_id_type(Symbol id)
+{
+	if (auto entry = scopes.find(id))
+		return entry->type;
 
-	return it->second;
+	return std::nullopt;
 }
\ No newline at end of file
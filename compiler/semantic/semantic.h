@@ -2,23 +2,76 @@
 
 #include <ast/ast.h>
 
+namespace syntax
+{
+	struct Update;
+}
+
 namespace semantic
 {
+	/*
+	* identifiers visible in the function being analyzed, declarations are
+	* pushed to one array and a scope is the tail of the array since its
+	* mark so leaving it is a truncate, every symbol points to its innermost
+	* declaration and each declaration to the one it shadows
+	*/
+	class ScopeStack
+	{
+	public:
+
+		static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+		struct Entry
+		{
+			Symbol name;
+
+			ast::Type type {};
+
+			ast::Expr* decl = nullptr;
+
+			uint32_t shadowed = NONE;
+		};
+
+	private:
+
+		std::vector<Entry> entries;
+		std::vector<uint32_t> marks;
+
+		// innermost declaration of every symbol indexed by the symbol id
+
+		std::vector<uint32_t> heads;
+
+		void truncate(size_t size);
+
+	public:
+
+		void enter()									{ marks.push_back(static_cast<uint32_t>(entries.size())); }
+		void exit()										{ truncate(marks.back()); marks.pop_back(); }
+		void clear()									{ truncate(0); marks.clear(); }
+
+		// false if the name is already declared in the current scope
+
+		bool declare(Symbol name, const ast::Type& type, ast::Expr* decl);
+
+		const Entry* find(Symbol name) const
+		{
+			return (name.id < heads.size() && heads[name.id] != NONE ? &entries[heads[name.id]] : nullptr);
+		}
+	};
+
 	struct PrototypeInfo
 	{
-		std::unordered_map<std::string, ast::Type> id_types;
-		std::unordered_set<ast::Expr*> analyzed_exprs;
+		ScopeStack scopes;
 
 		ast::Prototype* pt = nullptr;
 
-		void set_id_type(const std::string& id, const ast::Type& type);
+		bool declare(ast::Expr* decl)					{ return scopes.declare(decl->name, decl->type, decl); }
 
-		ast::TypeOpt get_id_type(const std::string& id);
+		ast::TypeOpt get_id_type(Symbol id);
 
 		PrototypeInfo& operator = (ast::Prototype* prototype)
 		{
-			id_types.clear();
-			analyzed_exprs.clear();
+			scopes.clear();
 			pt = prototype;
 			return *this;
 		}
@@ -26,11 +79,17 @@ namespace semantic
 
 	struct GlobalInfo
 	{
-		std::unordered_map<std::string, ast::Prototype*> prototypes;
+		std::unordered_map<Symbol, ast::Prototype*> prototypes;
 
 		void add_prototype(ast::Prototype* prototype) { prototypes.insert({ prototype->name, prototype }); }
+
+		void remove_prototype(ast::Prototype* prototype)
+		{
+			if (auto it = prototypes.find(prototype->name); it != prototypes.end() && it->second == prototype)
+				prototypes.erase(it);
+		}
 		
-		ast::Prototype* get_prototype(const std::string& name)
+		ast::Prototype* get_prototype(Symbol name)
 		{
 			const auto it = prototypes.find(name);
 			return (it == prototypes.end() ? nullptr : it->second);
@@ -43,6 +102,19 @@ namespace semantic
 
 		bool is_in_loop = false;
 	};
+
+	/*
+	* compound statement being analyzed, 'data' is what its statements get
+	* and 'step' the next part of it to analyze (see Semantic::analyze_stmt)
+	*/
+	struct StmtFrame
+	{
+		ast::Base* stmt = nullptr;
+
+		BodyData data {};
+
+		uint32_t step = 0;
+	};
 }
 
 class Semantic
@@ -51,24 +123,59 @@ private:
 
 	std::vector<std::string> errors;
 
-	semantic::GlobalInfo g_ctx {};
+	// the prototypes table is shared with the workers analyzing the
+	// function bodies in parallel (see Semantic::analyze_functions)
+
+	std::shared_ptr<semantic::GlobalInfo> g_ctx = std::make_shared<semantic::GlobalInfo>();
+
 	semantic::PrototypeInfo p_ctx {};
 
+	std::vector<semantic::StmtFrame> stmt_frames;
+
 	ast::AST* ast = nullptr;
 
+	// arena for the nodes added by the analysis (implicit casts)
+
+	ast::Arena* arena = nullptr;
+
+	// id of the current run, every expression keeps the id of the last
+	// run that analyzed it
+
+	static inline uint32_t last_epoch = 0;
+
+	uint32_t epoch = 0;
+
+	// functions reached from main when bodies are parsed lazily
+
+	std::vector<ast::Prototype*> reachable_functions;
+	std::unordered_set<ast::Prototype*> reached_functions;
+
+	// functions calling every name, the ones to analyze again when the
+	// signature behind a name changes (see Semantic::update)
+
+	std::unordered_map<Symbol, std::unordered_set<ast::Prototype*>> callers;
+
 	void enter_scope();
 	void exit_scope();
 	
+	void reach_function(ast::Prototype* function);
+	void analyze_prototype(ast::Prototype* prototype);
 	void analyze_function(ast::Prototype* function);
-
-	void analyze_body(ast::StmtBody* body, semantic::BodyData data);
+	void analyze_functions(size_t threads);
 
 	void analyze_stmt(ast::Base* stmt, semantic::BodyData data);
+	void open_stmt(ast::Base* stmt, semantic::BodyData data);
+	void open_body(ast::StmtBody* body, semantic::BodyData data);
+
+	// every compound statement is analyzed one step at a time, they
+	// return true once the statement is done
+
+	bool analyze_body(ast::StmtBody* body, semantic::BodyData data, uint32_t step);
+	bool analyze_if(ast::StmtIf* stmt, semantic::BodyData data, uint32_t step);
+	bool analyze_for(ast::StmtFor* stmt, semantic::BodyData data, uint32_t step);
+	bool analyze_while(ast::StmtWhile* stmt, semantic::BodyData data, uint32_t step);
+	bool analyze_do_while(ast::StmtDoWhile* stmt, semantic::BodyData data, uint32_t step);
 
-	void analyze_if(ast::StmtIf* stmt, semantic::BodyData data);
-	void analyze_for(ast::StmtFor* stmt, semantic::BodyData data);
-	void analyze_while(ast::StmtWhile* stmt, semantic::BodyData data);
-	void analyze_do_while(ast::StmtDoWhile* stmt, semantic::BodyData data);
 	void analyze_return(ast::StmtReturn* stmt, semantic::BodyData data);
 
 	void analyze_expr(ast::Expr* expr);
@@ -82,16 +189,24 @@ private:
 	void analyze_expr_cast(ast::ExprCast* expr);
 
 	ast::Type get_expr_type(ast::Expr* expr);
-	ast::Type get_id_type(const std::string& id);
+	ast::Type get_id_type(Symbol id);
 
 	ast::Expr* implicit_cast(ast::Expr* expr, const ast::Type& type);
 	void implicit_cast_replace(ast::Expr*& expr, const ast::Type& type);
 
+	ast::Expr* fold(ast::Expr* expr);
+	void fold_replace(ast::Expr*& expr);
+
 public:
 
 	void print_errors();
 
-	bool run();
+	bool run(size_t threads = 1);
+	bool update(const syntax::Update& update);
+
+	// functions never analyzed because main doesn't reach them (lazy bodies)
+
+	size_t get_skipped_count() const;
 
 	template <typename... A>
 	inline void add_error(const std::string& format, A... args)
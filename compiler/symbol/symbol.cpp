@@ -0,0 +1,55 @@
+#include <defs.h>
+
+#include "symbol.h"
+
+std::string_view SymbolTable::store(std::string_view str)
+{
+	const auto len = str.length();
+
+	if (len > chunk_left)
+	{
+		// strings bigger than a chunk get a chunk of their own so
+		// the current one can keep being filled
+
+		if (len > CHUNK_SIZE / 4)
+		{
+			auto& chunk = chunks.emplace_back(std::make_unique<char[]>(len));
+
+			std::memcpy(chunk.get(), str.data(), len);
+
+			return { chunk.get(), len };
+		}
+
+		chunk_cursor = chunks.emplace_back(std::make_unique<char[]>(CHUNK_SIZE)).get();
+		chunk_left = CHUNK_SIZE;
+	}
+
+	const auto stored = chunk_cursor;
+
+	std::memcpy(stored, str.data(), len);
+
+	chunk_cursor += len;
+	chunk_left -= len;
+
+	return { stored, len };
+}
+
+Symbol SymbolTable::intern(std::string_view str)
+{
+	if (auto it = symbols.find(str); it != symbols.end())
+		return Symbol(it->second);
+
+	const auto id = static_cast<uint32_t>(strings.size());
+	const auto stored = store(str);
+
+	strings.push_back(stored);
+	symbols.insert({ stored, id });
+
+	return Symbol(id);
+}
+
+Symbol SymbolTable::find(std::string_view str) const
+{
+	const auto it = symbols.find(str);
+	return (it != symbols.end() ? Symbol(it->second) : Symbol());
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+* interned identifier, two symbols are the same name if and only if
+* their ids are the same so comparing and hashing them is trivial
+*/
+struct Symbol
+{
+	static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+
+	uint32_t id = INVALID;
+
+	Symbol() {}
+	explicit Symbol(uint32_t id) : id(id) {}
+
+	bool is_valid() const						{ return id != INVALID; }
+	bool operator == (const Symbol& v) const	{ return id == v.id; }
+
+	std::string_view str() const;
+};
+
+namespace std
+{
+	template <> struct hash<Symbol>
+	{
+		size_t operator()(const Symbol& v) const { return v.id; }
+	};
+}
+
+/*
+* owns the text of every interned symbol, strings are packed in big
+* chunks and never move so the views handed out stay valid until the
+* table is destroyed
+*/
+class SymbolTable
+{
+private:
+
+	static constexpr size_t CHUNK_SIZE = 0x10000;
+
+	std::vector<std::unique_ptr<char[]>> chunks;
+	std::vector<std::string_view> strings;
+
+	std::unordered_map<std::string_view, uint32_t> symbols;
+
+	char* chunk_cursor = nullptr;
+
+	size_t chunk_left = 0;
+
+	std::string_view store(std::string_view str);
+
+public:
+
+	Symbol intern(std::string_view str);
+	Symbol find(std::string_view str) const;
+
+	std::string_view get(Symbol symbol) const			{ return strings[symbol.id]; }
+
+	size_t get_symbols_count() const					{ return strings.size(); }
+};
+
+inline std::unique_ptr<SymbolTable> g_symbols;
+
+inline std::string_view Symbol::str() const
+{
+	return (is_valid() ? g_symbols->get(*this) : std::string_view {});
+}
@@ -4,6 +4,62 @@
 
 #include <intrin/intrin.h>
 
+namespace syntax
+{
+	enum Associativity : uint8_t
+	{
+		Assoc_Left,
+		Assoc_Right,
+	};
+
+	/*
+	* how a token behaves in an expression, tokens without a handler for
+	* a position can't show up there, the higher the binding power the
+	* tighter the operator binds (derived from the lexer precedences)
+	*/
+	struct Operator
+	{
+		ast::Expr* (Syntax::*prefix)(Token* op, ast::Expr* rhs) = nullptr;
+		ast::Expr* (Syntax::*infix)(Token* op, ast::Expr* lhs, ast::Expr* rhs) = nullptr;
+		ast::Expr* (Syntax::*postfix)(Token* op, ast::Expr* lhs) = nullptr;
+
+		int binding_power = 0;
+
+		Associativity associativity = Assoc_Left;
+
+		// binary operator applied by compound assignments
+
+		TokenID assign_op = Token_None;
+	};
+
+	static constexpr auto OPERATORS = []()
+	{
+		std::array<Operator, Token_Count> operators {};
+
+		auto binding_power = [](TokenID id) { return Token::LOWEST_PRECEDENCE - g_token_precedences[id]; };
+
+		for (auto id : { Token_Add, Token_Sub, Token_Mul, Token_Div, Token_Mod, Token_And, Token_Or, Token_Xor, Token_Shr, Token_Shl,
+						 Token_Equal, Token_NotEqual, Token_Lt, Token_Lte, Token_Gt, Token_Gte, Token_LogicalAnd, Token_LogicalOr })
+			operators[id] = { .infix = &Syntax::make_binary_op, .binding_power = binding_power(id) };
+
+		operators[Token_Assign] = { .infix = &Syntax::make_assign, .binding_power = binding_power(Token_Assign), .associativity = Assoc_Right };
+
+		for (auto [id, op] : { std::pair { Token_AddAssign, Token_Add }, { Token_SubAssign, Token_Sub }, { Token_MulAssign, Token_Mul },
+							   { Token_DivAssign, Token_Div }, { Token_ModAssign, Token_Mod }, { Token_AndAssign, Token_And },
+							   { Token_OrAssign, Token_Or }, { Token_XorAssign, Token_Xor }, { Token_ShrAssign, Token_Shr },
+							   { Token_ShlAssign, Token_Shl } })
+			operators[id] = { .infix = &Syntax::make_binary_assign, .binding_power = binding_power(id), .associativity = Assoc_Right, .assign_op = op };
+
+		for (auto id : { Token_Sub, Token_Mul, Token_And, Token_Inc, Token_Dec, Token_LogicalNot })
+			operators[id].prefix = &Syntax::make_prefix_op;
+
+		for (auto id : { Token_Inc, Token_Dec })
+			operators[id].postfix = &Syntax::make_postfix_op;
+
+		return operators;
+	}();
+}
+
 Syntax::Syntax()
 {
 	ast = _ALLOC(ast::AST);
@@ -19,185 +75,724 @@ void Syntax::print_ast()
 	ast::Printer().print(ast);
 }
 
-void Syntax::run()
+void Syntax::print_errors()
 {
-	while (!g_lexer->eof())
+	for (const auto& err : errors)
+		PRINT(Red, "{}", err);
+}
+
+void Syntax::run(bool lazy_bodies, size_t threads)
+{
+	tokens = TokenStream(g_lexer.get());
+
+	// with several threads the bodies are skipped like the lazy ones and
+	// parsed in parallel once every prototype is known
+
+	this->lazy_bodies = lazy_bodies || threads > 1;
+
+	while (!tokens.eof())
 	{
-		if (auto prototype = parse_prototype())
-			ast->prototypes.push_back(prototype);
+		const auto index = tokens.get_index();
+
+		try
+		{
+			if (auto prototype = parse_prototype())
+				ast->prototypes.push_back(prototype);
+		}
+		catch (const compiler_exception& e)
+		{
+			// errors outside bodies drop the whole definition, parsing goes
+			// on from the next type keyword at the top level
+
+			add_error("{}", e.what());
+
+			stmt_frames.clear();
+			pending_ops.clear();
+
+			g_ctx.expect_semicolon = false;
+
+			if (tokens.get_index() == index)
+				tokens.advance();
+
+			synchronize(true);
+		}
 	}
+
+	if (!lazy_bodies && threads > 1)
+		parse_bodies(threads);
+
+	this->lazy_bodies = lazy_bodies;
+}
+
+void Syntax::parse_bodies(size_t threads)
+{
+	// every worker is a parser of its own (token cursor, frames and arena)
+	// taking the next pending body until there are none left, bodies are
+	// attached to their prototype so the tree keeps the source order
+
+	std::vector<ast::Prototype*> pending;
+
+	for (auto prototype : ast->prototypes)
+		if (prototype->lazy_body)
+			pending.push_back(prototype);
+
+	std::vector<std::unique_ptr<Syntax>> parsers(std::min(threads, pending.size()));
+	std::vector<std::future<void>> workers;
+	std::vector<std::vector<std::string>> body_errors(pending.size());
+
+	std::atomic_size_t next_body = 0;
+
+	for (auto& parser : parsers)
+	{
+		parser = std::make_unique<Syntax>();
+		parser->tokens = tokens;
+
+		workers.push_back(std::async(std::launch::async, [&, parser = parser.get()]()
+		{
+			for (size_t i = next_body++; i < pending.size(); i = next_body++)
+			{
+				parser->get_body(pending[i]);
+
+				body_errors[i] = std::move(parser->errors);
+
+				parser->errors.clear();
+			}
+		}));
+	}
+
+	// the nodes are moved to our arena before reporting any error so the
+	// parsed bodies outlive the workers
+
+	for (auto& worker : workers)
+		worker.wait();
+
+	for (auto& parser : parsers)
+		ast->arena.merge(parser->ast->arena);
+
+	for (auto& worker : workers)
+		worker.get();
+
+	// errors are reported in source order whatever worker found them
+
+	for (const auto& list : body_errors)
+		errors.insert(errors.end(), list.begin(), list.end());
+}
+
+std::optional<syntax::Update> Syntax::update(std::string source)
+{
+	// only the top level items touched by the edit are lexed and parsed
+	// again, the rest of the tree is kept as it is. nullopt means the tree
+	// can't be updated in place (lazy bodies, a tree without items, a
+	// function declared apart from its definition or a window that can't
+	// be parsed on its own) and the whole source must be compiled again,
+	// the previous tree and tokens are left as they were in that case
+
+	if (lazy_bodies || has_errors() || items.empty() != ast->prototypes.empty())
+		return {};
+
+	const auto edit = g_lexer->diff(source);
+
+	syntax::Update update {};
+
+	if (edit.begin == edit.old_end && edit.begin == edit.new_end)
+		return update;
+
+	const auto old_tokens = g_lexer->get_tokens();
+
+	auto item_begin = [&](const syntax::Item& item) { return old_tokens[item.first_token].offset; };
+	auto item_end = [&](const syntax::Item& item) { return g_lexer->get_end(&old_tokens[item.last_token - 1]); };
+
+	// the edit range is closed so an item right next to it is parsed
+	// again too, an edit could join its first or last token with another
+
+	const auto first_item = static_cast<size_t>(std::partition_point(items.begin(), items.end(), [&](const syntax::Item& item)
+	{
+		return item_end(item) < edit.begin;
+	}) - items.begin());
+
+	const auto last_item = static_cast<size_t>(std::partition_point(items.begin() + first_item, items.end(), [&](const syntax::Item& item)
+	{
+		return item_begin(item) <= edit.old_end;
+	}) - items.begin());
+
+	std::unordered_map<Symbol, ast::Prototype*> affected;
+
+	for (auto i = first_item; i < last_item; ++i)
+	{
+		if (!items[i].owner)
+			return {};
+
+		affected.insert({ items[i].prototype->name, items[i].prototype });
+	}
+
+	if (std::ranges::any_of(items, [&](const syntax::Item& item) { return !item.owner && affected.contains(item.prototype->name); }))
+		return {};
+
+	// the window goes from the end of the previous item to the beginning
+	// of the next one so it also covers the blanks and comments around
+
+	const auto first_token = (first_item < items.size() ? items[first_item].first_token : old_tokens.size()),
+			   last_token = (first_item < last_item ? items[last_item - 1].last_token : first_token);
+
+	const auto window_begin = (first_item > 0 ? item_end(items[first_item - 1]) : 0u),
+			   window_end = (last_item < items.size() ? item_begin(items[last_item]) : static_cast<uint32_t>(g_lexer->get_source_size()));
+
+	const auto first_prototype = std::count_if(items.begin(), items.begin() + first_item, [](const syntax::Item& item) { return item.owner; });
+
+	const auto new_tokens_count = g_lexer->relex(std::move(source), edit, window_begin, window_end, first_token, last_token);
+
+	if (!new_tokens_count)
+		return {};
+
+	for (const auto& [name, prototype] : affected)
+		g_ctx.prototypes.erase(name);
+
+	// the new items are parsed at the end of the list and moved to their
+	// place once the whole window is parsed
+
+	const auto items_count = items.size();
+	const auto tokens_end = first_token + *new_tokens_count;
+
+	// a window that doesn't parse puts the tokens, the items and the
+	// prototypes table back so the previous tree is still the current one,
+	// a definition of a function declared out of the window is the only
+	// change made to a prototype the tree already had
+
+	auto revert = [&]()
+	{
+		const auto new_tokens = g_lexer->get_tokens();
+
+		for (auto it = items.begin() + items_count; it != items.end(); ++it)
+		{
+			if (it->owner)
+				g_ctx.prototypes.erase(it->prototype->name);
+			else if (new_tokens[it->last_token - 1].id == Token_BracketClose)
+				it->prototype->body = nullptr;
+		}
+
+		for (const auto& [name, prototype] : affected)
+			g_ctx.prototypes[name] = prototype;
+
+		items.resize(items_count);
+		errors.clear();
+		stmt_frames.clear();
+		pending_ops.clear();
+
+		g_ctx.expect_semicolon = false;
+
+		g_lexer->undo_relex();
+
+		tokens = TokenStream(g_lexer.get());
+	};
+
+	tokens = TokenStream(g_lexer.get());
+	tokens.set_index(first_token);
+
+	try
+	{
+		while (tokens.get_index() < tokens_end)
+			if (!parse_prototype())
+			{
+				revert();
+				return {};
+			}
+	}
+	catch (const compiler_exception&)
+	{
+		revert();
+		return {};
+	}
+
+	if (has_errors() || tokens.get_index() != tokens_end)
+	{
+		revert();
+		return {};
+	}
+
+	std::vector<syntax::Item> new_items(items.begin() + items_count, items.end());
+
+	items.resize(items_count);
+
+	const auto tokens_delta = static_cast<ptrdiff_t>(*new_tokens_count) - static_cast<ptrdiff_t>(last_token - first_token);
+
+	for (auto i = last_item; i < items.size(); ++i)
+	{
+		items[i].first_token += tokens_delta;
+		items[i].last_token += tokens_delta;
+	}
+
+	// functions that keep their name keep their prototype too so the
+	// calls pointing to them stay valid
+
+	auto same_signature = [](ast::Prototype* a, ast::Prototype* b)
+	{
+		return a->type == b->type && std::ranges::equal(a->params, b->params, [](ast::Expr* x, ast::Expr* y) { return x->type == y->type; });
+	};
+
+	for (auto& item : new_items)
+	{
+		const auto name = item.prototype->name;
+
+		if (auto it = affected.find(name); it != affected.end())
+		{
+			if (!same_signature(it->second, item.prototype))
+				update.signatures.push_back(name);
+
+			*it->second = *item.prototype;
+
+			item.prototype = g_ctx.prototypes[name] = it->second;
+
+			affected.erase(it);
+		}
+		else update.signatures.push_back(name);
+
+		update.changed.push_back(item.prototype);
+	}
+
+	for (const auto& [name, prototype] : affected)
+	{
+		update.removed.push_back(prototype);
+		update.signatures.push_back(name);
+	}
+
+	items.erase(items.begin() + first_item, items.begin() + last_item);
+	items.insert(items.begin() + first_item, new_items.begin(), new_items.end());
+
+	const auto prototypes_it = ast->prototypes.begin() + first_prototype;
+
+	ast->prototypes.insert(ast->prototypes.erase(prototypes_it, prototypes_it + (last_item - first_item)), update.changed.begin(), update.changed.end());
+
+	return update;
+}
+
+bool Syntax::synchronize(bool top_level)
+{
+	// skips tokens up to the next point a statement (or a top level
+	// definition) can start from, a block found on the way is skipped
+	// whole and ends the statement, false means the source ended
+
+	while (!tokens.eof())
+	{
+		if (top_level)
+		{
+			if (tokens.is_token_keyword_type())
+				return true;
+		}
+		else if (tokens.eat_if_current_is(Token_Semicolon) || tokens.is_current(Token_BracketClose))
+			return true;
+
+		if (tokens.is_current(Token_BracketOpen) && tokens.skip_block())
+		{
+			if (!top_level)
+				return true;
+
+			continue;
+		}
+
+		tokens.advance();
+	}
+
+	return false;
+}
+
+std::string Syntax::get_location_str()
+{
+	// errors at the end of the source point to its last token
+
+	const auto all_tokens = g_lexer->get_tokens();
+
+	if (all_tokens.empty())
+		return "EOF";
+
+	return g_lexer->get_location_str(tokens.eof() ? &all_tokens.back() : tokens.current());
+}
+
+std::string_view Syntax::get_current_str()
+{
+	return (tokens.eof() ? "EOF" : g_lexer->get_value(tokens.current()));
 }
 
 ast::Prototype* Syntax::parse_prototype()
 {
+	const auto first_token = tokens.get_index();
+
 	auto type = parse_type(true);
-	auto id = g_lexer->eat_expect(Token_Id);
+	auto id = tokens.eat_expect(Token_Id);
 
-	check(id, "Expected an id");
+	expect(id, "Expected an id");
 
-	const auto& id_name = id->value;
+	const auto id_name = id->get_symbol();
 
-	check(g_lexer->eat_expect(Token_ParenOpen), "Expected '('");
+	expect(tokens.eat_expect(Token_ParenOpen), "Expected '('");
 
-	auto prototype = _ALLOC(ast::Prototype, id_name, type.value());
+	auto prototype = ast->arena.create<ast::Prototype>(id_name, type.value());
 
 	prototype->params = parse_prototype_params_decl();
 
-	g_lexer->eat_expect(Token_ParenClose);
+	tokens.eat_expect(Token_ParenClose);
 
 	auto prev_prototype = g_ctx.get_prototype(id_name);
 
 	if (prev_prototype)
 	{
-		check(prototype->type == prev_prototype->type, "Function {} has mismatched return types", prototype->name);
-		check(prototype->params.size() == prev_prototype->params.size(), "Function {} has different number of parameters", prototype->name);
+		expect(prototype->type == prev_prototype->type, "Function {} has mismatched return types", prototype->name.str());
+		expect(prototype->params.size() == prev_prototype->params.size(), "Function {} has different number of parameters", prototype->name.str());
 
 		for (int i = 0; i < prototype->params.size(); ++i)
-			check(prototype->params[i]->type == prev_prototype->params[i]->type,
-				"Function {} has mismatched parameters", prototype->name);
-
-		_FREE(prototype);
+			expect(prototype->params[i]->type == prev_prototype->params[i]->type,
+				"Function {} has mismatched parameters", prototype->name.str());
 
 		prototype = prev_prototype;
 	}
 	else g_ctx.add_prototype(prototype);
 
-	if (!g_lexer->eat_if_current_is(Token_Semicolon))
+	if (!tokens.eat_if_current_is(Token_Semicolon))
 	{
-		check(!prototype->body, "Function {} already has body", prototype->name);
-		prototype->body = parse_body(nullptr);
+		expect(!prototype->body && !prototype->lazy_body, "Function {} already has body", prototype->name.str());
+
+		if (lazy_bodies && tokens.is_current(Token_BracketOpen))
+		{
+			prototype->lazy_body = tokens.get_index();
+
+			expect(tokens.skip_block(), "Expected a '}}', got 'EOF'");
+		}
+		else prototype->body = parse_body();
 	}
 
+	items.push_back({ prototype, first_token, tokens.get_index(), !prev_prototype });
+
 	return prev_prototype ? nullptr : prototype;
 }
 
-ast::StmtBody* Syntax::parse_body(ast::StmtBody* body)
+ast::StmtBody* Syntax::parse_body()
 {
-	if (!g_lexer->eat_if_current_is(Token_BracketOpen))
+	if (!tokens.eat_if_current_is(Token_BracketOpen))
 		return nullptr;
 
-	auto curr_body = _ALLOC(ast::StmtBody);
+	// nested bodies and the compound statements owning them are frames in
+	// 'stmt_frames' instead of calls so the nesting depth is only limited
+	// by memory, frames below 'base' belong to the caller
+
+	const auto base = stmt_frames.size();
+
+	stmt_frames.push_back({ syntax::StmtFrame_Body, ast->arena.create<ast::StmtBody>() });
 
-	while (!g_lexer->eof())
+	ast::StmtBody* closed_body = nullptr;
+
+	while (true)
 	{
-		if (auto new_body = parse_body(curr_body))
-			curr_body->stmts.push_back(new_body);
+		// the frames pushed by a statement that fails are dropped with it
+
+		const auto frames_count = stmt_frames.size();
 
-		if (auto stmt = parse_statement())
+		try
 		{
-			curr_body->stmts.push_back(stmt);
+			const auto frame = stmt_frames.back();
 
-			if (g_ctx.expect_semicolon)
+			if (frame.type != syntax::StmtFrame_Body)
 			{
-				g_ctx.expect_semicolon = false;
+				// the body of the statement on top was just closed (or it's missing)
 
-				check(g_lexer->is_current(Token_Semicolon), "Missing token ';'");
+				auto body = closed_body;
 
-				g_lexer->eat();
+				closed_body = nullptr;
+
+				if (auto stmt = complete_statement(body))
+					add_statement(static_cast<ast::StmtBody*>(stmt_frames.back().stmt), stmt);
+
+				continue;
+			}
+
+			auto curr_body = static_cast<ast::StmtBody*>(frame.stmt);
+
+			if (tokens.eat_if_current_is(Token_BracketOpen))
+			{
+				stmt_frames.push_back({ syntax::StmtFrame_Body, ast->arena.create<ast::StmtBody>() });
+				continue;
+			}
+
+			if (auto stmt = tokens.eof() ? nullptr : parse_statement())
+			{
+				// compound statements are added once their bodies are parsed
+
+				if (stmt_frames.size() == frames_count)
+					add_statement(curr_body, stmt);
+
+				continue;
 			}
-			else if (g_lexer->is_current(Token_Semicolon))
-				g_lexer->eat();
+
+			if (!tokens.eat_if_current_is(Token_BracketClose))
+				syntax_error("Expected a '}}', got '{}'", get_current_str());
+
+			stmt_frames.pop_back();
+
+			if (stmt_frames.size() == base)
+				return curr_body;
+
+			if (stmt_frames.back().type == syntax::StmtFrame_Body)
+				static_cast<ast::StmtBody*>(stmt_frames.back().stmt)->stmts.push_back(curr_body);
+			else closed_body = curr_body;
 		}
-		else break;
+		catch (const compiler_exception& e)
+		{
+			// panic mode, the statement being parsed is dropped along with the
+			// frames and operators it pushed and parsing goes on after the next
+			// ';' or right before the '}' closing the current body
+
+			add_error("{}", e.what());
+
+			pending_ops.clear();
+
+			g_ctx.expect_semicolon = false;
+
+			closed_body = nullptr;
+
+			stmt_frames.resize(std::min(stmt_frames.size(), frames_count));
+
+			while (stmt_frames.back().type != syntax::StmtFrame_Body)
+				stmt_frames.pop_back();
+
+			if (!synchronize(false))
+			{
+				// the source ended with bodies still open
+
+				auto body = static_cast<ast::StmtBody*>(stmt_frames[base].stmt);
+
+				stmt_frames.resize(base);
+
+				return body;
+			}
+		}
+	}
+}
+
+ast::StmtBody* Syntax::get_body(ast::Prototype* prototype)
+{
+	if (prototype->lazy_body)
+	{
+		// the token cursor is moved to the body and back so bodies can
+		// be parsed in any order
+
+		const auto index = tokens.get_index();
+
+		tokens.set_index(*prototype->lazy_body);
+
+		prototype->body = parse_body();
+		prototype->lazy_body.reset();
+
+		tokens.set_index(index);
 	}
 
-	check(g_lexer->eat_expect(Token_BracketClose), "Expected a '}}', got '{}'", g_lexer->eof() ? "EOF" : g_lexer->current()->value);
-	
-	return curr_body;
+	return prototype->body;
 }
 
-ast::Base* Syntax::parse_statement()
+ast::StmtBody* Syntax::reparse_body(ast::Prototype* prototype)
 {
-	if (auto type = parse_type())
+	// semantic rewrites the bodies it analyzes so a function that needs
+	// to be analyzed again gets a fresh body parsed from its tokens
+
+	for (const auto& item : items)
 	{
-		auto id = g_lexer->eat_if_current_is(Token_Id);
+		if (item.prototype != prototype)
+			continue;
+
+		const auto item_tokens = g_lexer->get_tokens().subspan(item.first_token, item.last_token - item.first_token);
+		const auto body = std::ranges::find(item_tokens, Token_BracketOpen, &Token::id);
+
+		if (body == item_tokens.end())
+			continue;
 
-		check(id, "Expected an identifier, got '{}'", g_lexer->current()->value);
+		const auto index = tokens.get_index();
 
-		auto expr_value = g_lexer->eat_if_current_is(Token_Assign) ? parse_expression() : nullptr;
+		tokens.set_index(item.first_token + (body - item_tokens.begin()));
 
-		return return_and_expect_semicolon(_ALLOC(ast::ExprDecl, id->value, type.value(), expr_value));
+		prototype->body = parse_body();
+
+		tokens.set_index(index);
 	}
-	else if (auto curr_type = g_lexer->eat_if_current_is_keyword())
+
+	return prototype->body;
+}
+
+void Syntax::open_body(syntax::StmtFrameType type, ast::Base* stmt)
+{
+	stmt_frames.push_back({ type, stmt });
+
+	if (tokens.eat_if_current_is(Token_BracketOpen))
+		stmt_frames.push_back({ syntax::StmtFrame_Body, ast->arena.create<ast::StmtBody>() });
+}
+
+ast::Base* Syntax::complete_statement(ast::StmtBody* body)
+{
+	const auto [type, stmt] = stmt_frames.back();
+
+	stmt_frames.pop_back();
+
+	switch (type)
 	{
-		switch (curr_type->id)
+	case syntax::StmtFrame_If:
+	case syntax::StmtFrame_ElseIf:
+	{
+		auto if_stmt = static_cast<ast::StmtIf*>(stmt);
+
+		(type == syntax::StmtFrame_If ? if_stmt : if_stmt->ifs.back())->if_body = body;
+
+		if (tokens.is_current(Token_Else) && tokens.is_next(Token_If))
 		{
-		case Token_If:
+			tokens.eat();
+			tokens.eat();
+
+			tokens.eat_expect(Token_ParenOpen);
+
+			auto else_if_expr = parse_expression();
+
+			tokens.eat_expect(Token_ParenClose);
+
+			if_stmt->ifs.push_back(ast->arena.create<ast::StmtIf>(else_if_expr, nullptr));
+
+			open_body(syntax::StmtFrame_ElseIf, if_stmt);
+
+			return nullptr;
+		}
+
+		if (tokens.eat_if_current_is(Token_Else))
 		{
-			g_lexer->eat_expect(Token_ParenOpen);
+			open_body(syntax::StmtFrame_Else, if_stmt);
 
-			auto if_expr = parse_expression();
+			return nullptr;
+		}
 
-			g_lexer->eat_expect(Token_ParenClose);
+		return if_stmt;
+	}
+	case syntax::StmtFrame_Else:
+	{
+		static_cast<ast::StmtIf*>(stmt)->else_body = body;
+		break;
+	}
+	case syntax::StmtFrame_For:
+	{
+		static_cast<ast::StmtFor*>(stmt)->body = body;
+		break;
+	}
+	case syntax::StmtFrame_While:
+	{
+		static_cast<ast::StmtWhile*>(stmt)->body = body;
+		break;
+	}
+	case syntax::StmtFrame_DoWhile:
+	{
+		auto do_while_stmt = static_cast<ast::StmtDoWhile*>(stmt);
 
-			auto if_stmt = _ALLOC(ast::StmtIf, if_expr, parse_body(nullptr));
+		tokens.eat_expect(Token_While);
+		tokens.eat_expect(Token_ParenOpen);
 
-			if (g_lexer->is_current(Token_Else))
-			{
-				if (g_lexer->is_next(Token_If))
-				{
-					do {
-						g_lexer->eat();
-						g_lexer->eat();
+		do_while_stmt->condition = parse_expression(); tokens.eat_expect(Token_ParenClose);
+		do_while_stmt->body = body;
 
-						g_lexer->eat_expect(Token_ParenOpen);
+		break;
+	}
+	}
 
-						auto else_if_expr = parse_expression();
+	return stmt;
+}
 
-						g_lexer->eat_expect(Token_ParenClose);
+void Syntax::add_statement(ast::StmtBody* body, ast::Base* stmt)
+{
+	body->stmts.push_back(stmt);
 
-						if_stmt->ifs.push_back(_ALLOC(ast::StmtIf, else_if_expr, parse_body(nullptr)));
+	if (g_ctx.expect_semicolon)
+	{
+		g_ctx.expect_semicolon = false;
 
-					} while (!g_lexer->eof() && g_lexer->is_current(Token_Else) && g_lexer->is_next(Token_If));
-				}
+		expect(tokens.is_current(Token_Semicolon), "Missing token ';'");
 
-				if (g_lexer->is_current(Token_Else))
-				{
-					g_lexer->eat();
+		tokens.eat();
+	}
+	else if (tokens.is_current(Token_Semicolon))
+		tokens.eat();
+}
 
-					if_stmt->else_body = parse_body(nullptr);
-				}
-			}
+ast::Base* Syntax::parse_statement()
+{
+	if (auto type = parse_type())
+	{
+		auto id = tokens.eat_if_current_is(Token_Id);
+
+		if (!id)
+			syntax_error("Expected an identifier, got '{}'", get_current_str());
+
+		auto expr_value = tokens.eat_if_current_is(Token_Assign) ? parse_expression() : nullptr;
+
+		return return_and_expect_semicolon(ast->arena.create<ast::ExprDecl>(id->get_symbol(), type.value(), expr_value));
+	}
+	else if (auto curr_type = tokens.eat_if_current_is_keyword())
+	{
+		switch (curr_type->id)
+		{
+		case Token_If:
+		{
+			tokens.eat_expect(Token_ParenOpen);
+
+			auto if_expr = parse_expression();
+
+			tokens.eat_expect(Token_ParenClose);
+
+			auto if_stmt = ast->arena.create<ast::StmtIf>(if_expr, nullptr);
+
+			open_body(syntax::StmtFrame_If, if_stmt);
 
 			return if_stmt;
 		}
 		case Token_For:
 		{
-			g_lexer->eat_expect(Token_ParenOpen);
+			tokens.eat_expect(Token_ParenOpen);
 
-			auto init		= g_lexer->is_current(Token_Semicolon) ? nullptr : parse_statement();	g_lexer->eat_expect(Token_Semicolon);
-			auto condition	= g_lexer->is_current(Token_Semicolon) ? nullptr : parse_expression();	g_lexer->eat_expect(Token_Semicolon);
-			auto step		= g_lexer->is_current(Token_ParenClose) ? nullptr : parse_statement();	g_lexer->eat_expect(Token_ParenClose);
+			const auto frames_count = stmt_frames.size();
 
-			return _ALLOC(ast::StmtFor, condition, init, step, parse_body(nullptr));
+			auto init		= tokens.is_current(Token_Semicolon) ? nullptr : parse_statement();	tokens.eat_expect(Token_Semicolon);
+			auto condition	= tokens.is_current(Token_Semicolon) ? nullptr : parse_expression();	tokens.eat_expect(Token_Semicolon);
+			auto step		= tokens.is_current(Token_ParenClose) ? nullptr : parse_statement();	tokens.eat_expect(Token_ParenClose);
+
+			expect(stmt_frames.size() == frames_count, "Unexpected compound statement in 'for'");
+
+			// init and step are not followed by the ';' they asked for
+
+			g_ctx.expect_semicolon = false;
+
+			auto for_stmt = ast->arena.create<ast::StmtFor>(condition, init, step, nullptr);
+
+			open_body(syntax::StmtFrame_For, for_stmt);
+
+			return for_stmt;
 		}
 		case Token_While:
 		{
-			g_lexer->eat_expect(Token_ParenOpen);
+			tokens.eat_expect(Token_ParenOpen);
 
-			auto condition = parse_expression(); g_lexer->eat_expect(Token_ParenClose);
+			auto condition = parse_expression(); tokens.eat_expect(Token_ParenClose);
 
-			return _ALLOC(ast::StmtWhile, condition, parse_body(nullptr));
+			auto while_stmt = ast->arena.create<ast::StmtWhile>(condition, nullptr);
+
+			open_body(syntax::StmtFrame_While, while_stmt);
+
+			return while_stmt;
 		}
 		case Token_Do:
 		{
-			auto body = parse_body(nullptr);
-
-			g_lexer->eat_expect(Token_While);
-			g_lexer->eat_expect(Token_ParenOpen);
+			auto do_while_stmt = ast->arena.create<ast::StmtDoWhile>(nullptr, nullptr);
 
-			auto condition = parse_expression(); g_lexer->eat_expect(Token_ParenClose);
+			open_body(syntax::StmtFrame_DoWhile, do_while_stmt);
 
-			return _ALLOC(ast::StmtDoWhile, condition, body);
+			return do_while_stmt;
 		}
-		case Token_Break:		return return_and_expect_semicolon(_ALLOC(ast::StmtBreak));
-		case Token_Continue:	return return_and_expect_semicolon(_ALLOC(ast::StmtContinue));
+		case Token_Break:		return return_and_expect_semicolon(ast->arena.create<ast::StmtBreak>());
+		case Token_Continue:	return return_and_expect_semicolon(ast->arena.create<ast::StmtContinue>());
 		case Token_Return:
 		{
-			if (auto expr_value = g_lexer->is_current(Token_Semicolon) ? nullptr : parse_expression())
-				return _ALLOC(ast::StmtReturn, expr_value);
+			if (auto expr_value = tokens.is_current(Token_Semicolon) ? nullptr : parse_expression())
+				return ast->arena.create<ast::StmtReturn>(expr_value);
 
-			return return_and_expect_semicolon(_ALLOC(ast::StmtReturn, nullptr));
+			return return_and_expect_semicolon(ast->arena.create<ast::StmtReturn>(nullptr));
 		}
 		}
 	}
@@ -207,150 +802,167 @@ ast::Base* Syntax::parse_statement()
 
 ast::Expr* Syntax::parse_expression()
 {
-	return parse_expression_precedence(parse_primary_expression());
-}
+	// operators waiting for their rhs are kept in 'pending_ops' instead of
+	// the call stack, left associative chains never hold more than one of
+	// them and nested expressions (parenthesis, call params) stack theirs
+	// on top of the current ones
+
+	const auto base = pending_ops.size();
+
+	auto lhs = parse_unary_expression();
 
-ast::Expr* Syntax::parse_expression_precedence(ast::Expr* lhs, int min_precedence)
-{
 	if (!lhs)
 		return nullptr;
 
-	auto lookahead = g_lexer->current();
+	int min_binding_power = 0;
 
-	while ((lookahead->flags & TokenFlag_Op) && lookahead->precedence <= min_precedence)
+	while (true)
 	{
-		auto op = lookahead;
+		const auto& info = syntax::OPERATORS[tokens.current_token_id()];
 
-		g_lexer->eat();
+		if (info.infix && info.binding_power > min_binding_power)
+		{
+			pending_ops.push_back({ lhs, tokens.eat(), min_binding_power });
 
-		auto rhs = parse_primary_expression();
+			min_binding_power = (info.associativity == syntax::Assoc_Left ? info.binding_power : info.binding_power - 1);
 
-		lookahead = g_lexer->current();
+			lhs = parse_unary_expression();
 
-		while ((lookahead->flags & TokenFlag_Op) && lookahead->precedence < op->precedence)
-		{
-			rhs = parse_expression_precedence(rhs, lookahead->precedence);
-			lookahead = g_lexer->current();
+			expect(lhs, "Expected expression");
 		}
-
-		check(rhs, "Expected expression");
-
-		if (op->flags & TokenFlag_Assignation)
+		else if (pending_ops.size() > base)
 		{
-			TokenID new_operator = Token_None;
+			const auto pending = pending_ops.back();
 
-			switch (op->id)
-			{
-			case Token_ShrAssign: new_operator = Token_Shr; break;
-			case Token_ShlAssign: new_operator = Token_Shl; break;
-			case Token_AddAssign: new_operator = Token_Add; break;
-			case Token_SubAssign: new_operator = Token_Sub; break;
-			case Token_MulAssign: new_operator = Token_Mul; break;
-			case Token_ModAssign: new_operator = Token_Mod; break;
-			case Token_DivAssign: new_operator = Token_Div; break;
-			case Token_AndAssign: new_operator = Token_And; break;
-			case Token_OrAssign: new_operator = Token_Or; break;
-			case Token_XorAssign: new_operator = Token_Xor; break;
-			}
+			pending_ops.pop_back();
 
-			if (new_operator != Token_None)
-			{
-				lhs = _ALLOC(ast::ExprBinaryAssign, lhs, rhs, Token::to_bin_op_type(new_operator));
-			}
-			else
-			{
-				lhs = _ALLOC(ast::ExprAssign, lhs, rhs);
-			}
-		}
-		else
-		{
-			auto op_type = op->to_bin_op_type();
-			lhs = _ALLOC(ast::ExprBinaryOp, lhs, rhs, op_type, lhs->type);
+			lhs = (this->*syntax::OPERATORS[pending.op->id].infix)(pending.op, pending.lhs, lhs);
+			min_binding_power = pending.min_binding_power;
 		}
+		else break;
 	}
 
 	return lhs;
 }
 
-ast::Expr* Syntax::parse_primary_expression()
+ast::Expr* Syntax::parse_unary_expression()
 {
-	auto first = g_lexer->current();
+	// prefix operators are consecutive tokens so they are applied walking
+	// them backwards once the operand is parsed
 
-	ast::Expr* ret_expr = nullptr;
+	auto first = tokens.current();
+
+	size_t prefix_ops = 0;
+
+	for (; syntax::OPERATORS[tokens.current_token_id()].prefix; ++prefix_ops)
+		tokens.eat();
+
+	auto expr = parse_primary_expression();
 
-	if (g_lexer->eat_if_current_is_int_literal())
-		ret_expr = _ALLOC(ast::ExprIntLiteral, first->value, first->to_ast_type());
-	else if (g_lexer->eat_if_current_is(Token_Sub) ||
-			 g_lexer->eat_if_current_is(Token_Mul) ||
-			 g_lexer->eat_if_current_is(Token_And) ||
-			 g_lexer->eat_if_current_is(Token_Inc) ||
-			 g_lexer->eat_if_current_is(Token_Dec) ||
-			 g_lexer->eat_if_current_is(Token_LogicalNot))
+	for (auto op = first + prefix_ops; op != first;)
 	{
-		auto rhs = parse_primary_expression();
+		--op;
 
-		check(rhs, "Expected expression");
+		expect(expr, "Expected expression");
 
-		ret_expr = _ALLOC(ast::ExprUnaryOp, rhs, first->to_unary_op_type());
+		expr = parse_postfix_expression((this->*syntax::OPERATORS[op->id].prefix)(op, expr));
 	}
-	else if (auto id = g_lexer->eat_if_current_is(Token_Id))
+
+	return expr;
+}
+
+ast::Expr* Syntax::parse_primary_expression()
+{
+	auto first = tokens.current();
+
+	ast::Expr* ret_expr = nullptr;
+
+	if (tokens.eat_if_current_is_int_literal())
+		ret_expr = ast->arena.create<ast::ExprIntLiteral>(g_lexer->get_literal(first), first->to_ast_type());
+	else if (auto id = tokens.eat_if_current_is(Token_Id))
 	{
-		if (g_lexer->current_token_id() == Token_ParenOpen) 
+		if (tokens.current_token_id() == Token_ParenOpen) 
 		{
-			g_lexer->eat();
+			tokens.eat();
 
-			auto call = _ALLOC(ast::ExprCall, id->value, g_intrin->is_intrinsic(id->value));
+			auto call = ast->arena.create<ast::ExprCall>(id->get_symbol(), g_intrin->is_intrinsic(id->get_symbol()));
 
 			call->exprs = parse_call_params();
 
-			g_lexer->eat_expect(Token_ParenClose);
+			tokens.eat_expect(Token_ParenClose);
 
 			ret_expr = call;
 		}
 		else
 		{
-			ret_expr = _ALLOC(ast::ExprId, id->value);
+			ret_expr = ast->arena.create<ast::ExprId>(id->get_symbol());
 		}
 	}
-	else if (g_lexer->eat_if_current_is(Token_ParenOpen))
+	else if (tokens.eat_if_current_is(Token_ParenOpen))
 	{
 		ret_expr = parse_expression();
 
-		check(ret_expr, "Expected expression");
-		check(g_lexer->eat_if_current_is(Token_ParenClose), "Expected ')', got '{}'", g_lexer->current()->value);
+		expect(ret_expr, "Expected expression");
+
+		if (!tokens.eat_if_current_is(Token_ParenClose))
+			syntax_error("Expected ')', got '{}'", get_current_str());
 	}
 
-	auto curr = g_lexer->current();
+	return parse_postfix_expression(ret_expr);
+}
 
-	switch (auto token_id = g_lexer->current_token_id())
-	{
-	case Token_Dec:
-	case Token_Inc:
-	{
-		g_lexer->eat();
+ast::Expr* Syntax::parse_postfix_expression(ast::Expr* expr)
+{
+	if (!expr)
+		return nullptr;
 
-		ret_expr = _ALLOC(ast::ExprUnaryOp, ret_expr, curr->to_unary_op_type(), false);
+	if (auto postfix = syntax::OPERATORS[tokens.current_token_id()].postfix)
+		return (this->*postfix)(tokens.eat(), expr);
 
-		break;
-	}
-	}
+	return expr;
+}
 
-	return ret_expr;
+ast::Expr* Syntax::make_prefix_op(Token* op, ast::Expr* rhs)
+{
+	return ast->arena.create<ast::ExprUnaryOp>(rhs, op->to_unary_op_type());
+}
+
+ast::Expr* Syntax::make_postfix_op(Token* op, ast::Expr* lhs)
+{
+	return ast->arena.create<ast::ExprUnaryOp>(lhs, op->to_unary_op_type(), false);
+}
+
+ast::Expr* Syntax::make_binary_op(Token* op, ast::Expr* lhs, ast::Expr* rhs)
+{
+	return ast->arena.create<ast::ExprBinaryOp>(lhs, rhs, op->to_bin_op_type(), lhs->type);
+}
+
+ast::Expr* Syntax::make_assign(Token* op, ast::Expr* lhs, ast::Expr* rhs)
+{
+	return ast->arena.create<ast::ExprAssign>(lhs, rhs);
+}
+
+ast::Expr* Syntax::make_binary_assign(Token* op, ast::Expr* lhs, ast::Expr* rhs)
+{
+	return ast->arena.create<ast::ExprBinaryAssign>(lhs, rhs, Token::to_bin_op_type(syntax::OPERATORS[op->id].assign_op));
 }
 
 ast::TypeOpt Syntax::parse_type(bool expect)
 {
-	auto token = expect ? g_lexer->eat_expect_keyword_declaration()
-						: g_lexer->eat_if_current_is_type();
+	auto token = expect ? tokens.eat_expect_keyword_declaration()
+						: tokens.eat_if_current_is_type();
 
 	if (!token)
 		return {};
 
 	int type_indirection = 0;
 
-	while (g_lexer->eat_if_current_is(Token_Mul))
+	while (tokens.eat_if_current_is(Token_Mul))
 		++type_indirection;
 
+	if (type_indirection > ast::TypeContext::MAX_INDIRECTION)
+		syntax_error("Too many indirections, the maximum is {}", ast::TypeContext::MAX_INDIRECTION);
+
 	return token->to_ast_type(type_indirection);
 }
 
@@ -358,22 +970,22 @@ std::vector<ast::Expr*> Syntax::parse_prototype_params_decl()
 {
 	std::vector<ast::Expr*> exprs;
 
-	while (!g_lexer->eof())
+	while (!tokens.eof())
 	{
 		auto type = parse_type();
 		if (!type)
 			break;
 
-		auto id = g_lexer->eat_if_current_is(Token_Id);
+		auto id = tokens.eat_if_current_is(Token_Id);
 
-		check(id, "Expected identifier");
+		expect(id, "Expected identifier");
 
-		exprs.push_back(_ALLOC(ast::ExprDecl, id->value, type.value()));
+		exprs.push_back(ast->arena.create<ast::ExprDecl>(id->get_symbol(), type.value()));
 
-		if (!g_lexer->is_current(Token_Comma))
+		if (!tokens.is_current(Token_Comma))
 			break;
 
-		g_lexer->eat();
+		tokens.eat();
 	}
 
 	return exprs;
@@ -385,7 +997,7 @@ std::vector<ast::Expr*> Syntax::parse_call_params()
 
 	int param_index = 0;
 
-	while (!g_lexer->eof() && !g_lexer->is_current(Token_ParenClose))
+	while (!tokens.eof() && !tokens.is_current(Token_ParenClose))
 	{
 		auto expr_param = parse_expression();
 		if (!expr_param)
@@ -393,10 +1005,10 @@ std::vector<ast::Expr*> Syntax::parse_call_params()
 
 		exprs.push_back(expr_param);
 
-		if (!g_lexer->is_current(Token_Comma))
+		if (!tokens.is_current(Token_Comma))
 			break;
 
-		g_lexer->eat();
+		tokens.eat();
 	}
 
 	return exprs;
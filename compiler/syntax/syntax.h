@@ -6,18 +6,81 @@ namespace syntax
 {
 	struct GlobalContext
 	{
-		std::unordered_map<std::string, ast::Prototype*> prototypes;
+		std::unordered_map<Symbol, ast::Prototype*> prototypes;
 
 		bool expect_semicolon = false;
 
 		void add_prototype(ast::Prototype* prototype) { prototypes.insert({ prototype->name, prototype }); }
 
-		ast::Prototype* get_prototype(const std::string& name)
+		ast::Prototype* get_prototype(Symbol name)
 		{
 			auto it = prototypes.find(name);
 			return it != prototypes.end() ? it->second : nullptr;
 		}
 	};
+
+	enum StmtFrameType : uint8_t
+	{
+		StmtFrame_Body,
+		StmtFrame_If,
+		StmtFrame_ElseIf,
+		StmtFrame_Else,
+		StmtFrame_For,
+		StmtFrame_While,
+		StmtFrame_DoWhile,
+	};
+
+	/*
+	* body being parsed or compound statement waiting for its body, for
+	* if/else-if/else frames 'stmt' is always the first if of the chain
+	*/
+	struct StmtFrame
+	{
+		StmtFrameType type = StmtFrame_Body;
+
+		ast::Base* stmt = nullptr;
+	};
+
+	/*
+	* tokens of one top level definition or declaration, a function declared
+	* before its definition has several items and only the first one owns
+	* the prototype
+	*/
+	struct Item
+	{
+		ast::Prototype* prototype = nullptr;
+
+		size_t first_token = 0,
+			   last_token = 0;
+
+		bool owner = false;
+	};
+
+	/*
+	* prototypes touched by an incremental update (see Syntax::update),
+	* 'signatures' has the names of the functions added, removed or with a
+	* different signature, the functions calling them must be analyzed again
+	*/
+	struct Update
+	{
+		std::vector<ast::Prototype*> changed,
+									 removed;
+
+		std::vector<Symbol> signatures;
+	};
+
+	/*
+	* infix operator waiting for its right hand side while the expression
+	* parser reads operators that bind tighter
+	*/
+	struct PendingOp
+	{
+		ast::Expr* lhs = nullptr;
+
+		Token* op = nullptr;
+
+		int min_binding_power = 0;
+	};
 }
 
 class Syntax
@@ -26,15 +89,57 @@ private:
 
 	syntax::GlobalContext g_ctx {};
 
+	TokenStream tokens;
+
+	std::vector<syntax::StmtFrame> stmt_frames;
+	std::vector<syntax::PendingOp> pending_ops;
+
+	std::vector<syntax::Item> items;
+
+	std::vector<std::string> errors;
+
 	ast::AST* ast = nullptr;
 
+	bool lazy_bodies = false;
+
 public:
 
 	Syntax();
 	~Syntax();
 
 	void print_ast();
-	void run();
+	void print_errors();
+	void run(bool lazy_bodies = false, size_t threads = 1);
+	void parse_bodies(size_t threads);
+
+	std::optional<syntax::Update> update(std::string source);
+
+	template <typename... A>
+	inline void add_error(const std::string& format, A... args)
+	{
+		errors.push_back(std::format(format, args...));
+	}
+
+	// errors are thrown with the location of the current token and caught
+	// at the closest recovery point (see Syntax::parse_body and Syntax::run)
+
+	template <typename... A>
+	[[noreturn]] inline void syntax_error(const std::string& format, A... args)
+	{
+		throw compiler_exception(std::format("{} -> ", get_location_str()) + std::format(format, args...));
+	}
+
+	template <typename... A>
+	inline void expect(bool condition, const std::string& format, A... args)
+	{
+		if (!condition)
+			syntax_error(format, args...);
+	}
+
+	std::string get_location_str();
+	std::string_view get_current_str();
+
+	bool synchronize(bool top_level);
 
 	template <typename T>
 	T* return_and_expect_semicolon(T* v)
@@ -48,13 +153,29 @@ public:
 	}
 
 	ast::Prototype* parse_prototype();
-	ast::StmtBody* parse_body(ast::StmtBody* body);
+	ast::StmtBody* parse_body();
+	ast::StmtBody* get_body(ast::Prototype* prototype);
+	ast::StmtBody* reparse_body(ast::Prototype* prototype);
 	ast::Base* parse_statement();
+	ast::Base* complete_statement(ast::StmtBody* body);
+	void open_body(syntax::StmtFrameType type, ast::Base* stmt);
+	void add_statement(ast::StmtBody* body, ast::Base* stmt);
 	ast::Expr* parse_expression();
-	ast::Expr* parse_expression_precedence(ast::Expr* lhs, int min_precedence = Token::LOWEST_PRECEDENCE);
+	ast::Expr* parse_unary_expression();
 	ast::Expr* parse_primary_expression();
+	ast::Expr* parse_postfix_expression(ast::Expr* expr);
+	ast::Expr* make_prefix_op(Token* op, ast::Expr* rhs);
+	ast::Expr* make_postfix_op(Token* op, ast::Expr* lhs);
+	ast::Expr* make_binary_op(Token* op, ast::Expr* lhs, ast::Expr* rhs);
+	ast::Expr* make_assign(Token* op, ast::Expr* lhs, ast::Expr* rhs);
+	ast::Expr* make_binary_assign(Token* op, ast::Expr* lhs, ast::Expr* rhs);
 	ast::AST* get_ast()			{ return ast; }
 
+	bool has_lazy_bodies() const	{ return lazy_bodies; }
+	bool has_errors() const			{ return !errors.empty(); }
+
+	size_t get_errors_count() const	{ return errors.size(); }
+
 	ast::TypeOpt parse_type(bool expect = false);
 
 	std::vector<ast::Expr*> parse_prototype_params_decl();